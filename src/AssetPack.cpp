@@ -0,0 +1,262 @@
+#include "AssetPack.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+
+namespace {
+    constexpr char MAGIC[4] = {'V', 'N', 'P', 'K'};
+
+    struct PackHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t namesSize;
+        std::uint64_t indexOffset;
+        std::uint64_t namesOffset;
+    };
+}
+
+struct AssetPack::Entry {
+    std::uint64_t hash;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    float scaleX;
+    float scaleY;
+};
+
+static_assert(sizeof(PackHeader) == 32, "pack header must stay fixed-size");
+
+AssetPack& AssetPack::getInstance() {
+    static AssetPack instance;
+    return instance;
+}
+
+bool AssetPack::mount(const std::string& packPath) {
+    unmount();
+
+    std::error_code ec;
+    if (!std::filesystem::exists(packPath, ec)) {
+        return false;
+    }
+
+    MappedFile mapped;
+    PackHeader header{};
+    if (!mapped.open(packPath) || mapped.getSize() < sizeof(PackHeader)) {
+        std::cerr << "Failed to open asset pack: " << packPath << std::endl;
+        return false;
+    }
+    std::memcpy(&header, mapped.getData(), sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        std::cerr << "Unsupported asset pack: " << packPath << std::endl;
+        return false;
+    }
+
+    const std::uint64_t fileSize = mapped.getSize();
+    if (header.indexOffset % alignof(Entry) != 0 || header.indexOffset > fileSize ||
+        static_cast<std::uint64_t>(header.entryCount) * sizeof(Entry) > fileSize - header.indexOffset ||
+        header.namesOffset > fileSize || header.namesSize > fileSize - header.namesOffset) {
+        std::cerr << "Corrupt asset pack: " << packPath << std::endl;
+        return false;
+    }
+
+    const auto* index = reinterpret_cast<const Entry*>(mapped.getData() + header.indexOffset);
+    for (std::uint32_t i = 0; i < header.entryCount; ++i) {
+        const Entry& entry = index[i];
+        if (entry.offset > fileSize || entry.size > fileSize - entry.offset ||
+            static_cast<std::uint64_t>(entry.nameOffset) + entry.nameLength > header.namesSize ||
+            !(entry.scaleX > 0.0f) || !(entry.scaleY > 0.0f) ||
+            (i > 0 && index[i - 1].hash > entry.hash)) {
+            std::cerr << "Corrupt asset pack: " << packPath << std::endl;
+            return false;
+        }
+    }
+
+    file = std::move(mapped);
+    entries = index;
+    entryCount = header.entryCount;
+    names = file.getData() + header.namesOffset;
+    root = std::filesystem::current_path(ec).generic_string();
+    return true;
+}
+
+void AssetPack::unmount() {
+    file.close();
+    entries = nullptr;
+    entryCount = 0;
+    names = nullptr;
+    root.clear();
+}
+
+std::string AssetPack::keyFor(const std::string& path) const {
+    std::filesystem::path key(path);
+    if (key.is_absolute() && !root.empty()) {
+        const std::filesystem::path relative = key.lexically_relative(root);
+        if (!relative.empty() && *relative.begin() != "..") {
+            key = relative;
+        }
+    }
+    return key.lexically_normal().generic_string();
+}
+
+AssetPack::Blob AssetPack::find(const std::string& path) const {
+    if (!isMounted()) {
+        return {};
+    }
+
+    const std::string key = keyFor(path);
+    const std::uint64_t hash = hashString(key);
+    const Entry* end = entries + entryCount;
+    const Entry* it = std::lower_bound(entries, end, hash,
+                                       [](const Entry& entry, const std::uint64_t value) { return entry.hash < value; });
+    for (; it != end && it->hash == hash; ++it) {
+        if (key.compare(0, std::string::npos, names + it->nameOffset, it->nameLength) == 0) {
+            return {file.getData() + it->offset, static_cast<std::size_t>(it->size), {it->scaleX, it->scaleY}};
+        }
+    }
+    return {};
+}
+
+std::vector<std::string> AssetPack::listFiles(const std::string& directory) const {
+    std::vector<std::string> files;
+    const std::string prefix = keyFor(directory) + '/';
+    for (std::size_t i = 0; i < entryCount; ++i) {
+        const std::string_view name(names + entries[i].nameOffset, entries[i].nameLength);
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            name.find('/', prefix.size()) == std::string_view::npos) {
+            files.emplace_back(name.substr(prefix.size()));
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool AssetPack::loadImage(const std::string& path, sf::Image& image) const {
+    if (const Blob blob = find(path)) {
+        return image.loadFromMemory(blob.data, blob.size);
+    }
+    return image.loadFromFile(path);
+}
+
+bool AssetPack::loadTexture(const std::string& path, sf::Texture& texture) const {
+    if (const Blob blob = find(path)) {
+        return texture.loadFromMemory(blob.data, blob.size);
+    }
+    return texture.loadFromFile(path);
+}
+
+bool AssetPack::openFont(const std::string& path, sf::Font& font) const {
+    if (const Blob blob = find(path)) {
+        return font.openFromMemory(blob.data, blob.size);
+    }
+    return font.openFromFile(path);
+}
+
+bool AssetPack::openMusic(const std::string& path, sf::Music& music) const {
+    if (const Blob blob = find(path)) {
+        return music.openFromMemory(blob.data, blob.size);
+    }
+    return music.openFromFile(path);
+}
+
+bool AssetPack::loadSoundBuffer(const std::string& path, sf::SoundBuffer& buffer) const {
+    if (const Blob blob = find(path)) {
+        return buffer.loadFromMemory(blob.data, blob.size);
+    }
+    return buffer.loadFromFile(path);
+}
+
+bool AssetPackWriter::open(const std::string& packPath) {
+    records.clear();
+    path = packPath;
+    out.open(packPath, std::ios::binary | std::ios::trunc);
+    const PackHeader placeholder{};
+    out.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+    offset = sizeof(placeholder);
+    if (!out) {
+        std::cerr << "Failed to create asset pack: " << packPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool AssetPackWriter::add(const std::string& key, const char* data, const std::size_t size, const sf::Vector2f scale) {
+    const std::uint64_t hash = hashString(key);
+    for (const Record& record : records) {
+        if (record.hash == hash && record.key == key) {
+            std::cerr << "Duplicate asset pack entry: " << key << std::endl;
+            return false;
+        }
+    }
+
+    const std::uint64_t aligned = (offset + AssetPack::ALIGNMENT - 1) & ~static_cast<std::uint64_t>(AssetPack::ALIGNMENT - 1);
+    static constexpr char padding[AssetPack::ALIGNMENT] = {};
+    out.write(padding, static_cast<std::streamsize>(aligned - offset));
+    out.write(data, static_cast<std::streamsize>(size));
+    if (!out) {
+        std::cerr << "Failed to write asset pack: " << path << std::endl;
+        return false;
+    }
+
+    records.push_back({hash, aligned, size, scale, key});
+    offset = aligned + size;
+    return true;
+}
+
+bool AssetPackWriter::addFile(const std::string& key, const std::string& filePath) {
+    MappedFile source;
+    if (source.open(filePath)) {
+        return add(key, source.getData(), source.getSize());
+    }
+
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(filePath, ec) && std::filesystem::file_size(filePath, ec) == 0 && !ec) {
+        return add(key, "", 0);
+    }
+    std::cerr << "Failed to read asset: " << filePath << std::endl;
+    return false;
+}
+
+bool AssetPackWriter::finish() {
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.key < b.key;
+    });
+
+    std::vector<AssetPack::Entry> index;
+    std::string nameData;
+    index.reserve(records.size());
+    for (const Record& record : records) {
+        index.push_back({record.hash, record.offset, record.size,
+                         static_cast<std::uint32_t>(nameData.size()), static_cast<std::uint32_t>(record.key.size()),
+                         record.scale.x, record.scale.y});
+        nameData += record.key;
+    }
+
+    PackHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = AssetPack::VERSION;
+    header.entryCount = static_cast<std::uint32_t>(index.size());
+    header.namesSize = static_cast<std::uint32_t>(nameData.size());
+
+    const std::uint64_t aligned = (offset + alignof(AssetPack::Entry) - 1) & ~static_cast<std::uint64_t>(alignof(AssetPack::Entry) - 1);
+    static constexpr char padding[alignof(AssetPack::Entry)] = {};
+    out.write(padding, static_cast<std::streamsize>(aligned - offset));
+    header.indexOffset = aligned;
+    header.namesOffset = aligned + index.size() * sizeof(AssetPack::Entry);
+    out.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(AssetPack::Entry)));
+    out.write(nameData.data(), static_cast<std::streamsize>(nameData.size()));
+    offset = header.namesOffset + nameData.size();
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out) {
+        std::cerr << "Failed to write asset pack: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "MappedFile.hpp"
+#include <SFML/Audio/Music.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class AssetPack {
+public:
+    static constexpr std::uint32_t VERSION = 2;
+    static constexpr std::size_t ALIGNMENT = 16;
+    static constexpr const char* DEFAULT_PATH = "assets.vnpack";
+
+    struct Blob {
+        const char* data{nullptr};
+        std::size_t size{0};
+        sf::Vector2f scale{1.0f, 1.0f};
+
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    static AssetPack& getInstance();
+
+    bool mount(const std::string& packPath);
+    void unmount();
+    [[nodiscard]] bool isMounted() const { return file.isOpen(); }
+
+    [[nodiscard]] std::string keyFor(const std::string& path) const;
+    [[nodiscard]] Blob find(const std::string& path) const;
+    [[nodiscard]] std::vector<std::string> listFiles(const std::string& directory) const;
+
+    bool loadImage(const std::string& path, sf::Image& image) const;
+    bool loadTexture(const std::string& path, sf::Texture& texture) const;
+    bool openFont(const std::string& path, sf::Font& font) const;
+    bool openMusic(const std::string& path, sf::Music& music) const;
+    bool loadSoundBuffer(const std::string& path, sf::SoundBuffer& buffer) const;
+
+private:
+    friend class AssetPackWriter;
+    struct Entry;
+
+    AssetPack() = default;
+
+    MappedFile file;
+    const Entry* entries{nullptr};
+    std::size_t entryCount{0};
+    const char* names{nullptr};
+    std::string root;
+};
+
+class AssetPackWriter {
+public:
+    bool open(const std::string& packPath);
+    bool add(const std::string& key, const char* data, std::size_t size, sf::Vector2f scale = {1.0f, 1.0f});
+    bool addFile(const std::string& key, const std::string& path);
+    bool finish();
+
+    [[nodiscard]] std::size_t getEntryCount() const { return records.size(); }
+    [[nodiscard]] std::uint64_t getSize() const { return offset; }
+
+private:
+    struct Record {
+        std::uint64_t hash;
+        std::uint64_t offset;
+        std::uint64_t size;
+        sf::Vector2f scale;
+        std::string key;
+    };
+
+    std::ofstream out;
+    std::string path;
+    std::vector<Record> records;
+    std::uint64_t offset{0};
+};
@@ -0,0 +1,158 @@
+#include "AtlasPacker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+AtlasPacker::AtlasPacker(const sf::Vector2u size) {
+    reset(size);
+}
+
+void AtlasPacker::reset(const sf::Vector2u newSize) {
+    size = newSize;
+    skyline.clear();
+    skyline.push_back({0, 0, size.x});
+    usedHeight = 0;
+    usedArea = 0;
+}
+
+std::optional<unsigned int> AtlasPacker::fitHeight(const std::size_t nodeIndex, const sf::Vector2u rectSize) const {
+    const unsigned int x = skyline[nodeIndex].x;
+    if (x + rectSize.x > size.x) {
+        return std::nullopt;
+    }
+
+    unsigned int y = 0;
+    unsigned int widthLeft = rectSize.x;
+    for (std::size_t i = nodeIndex; widthLeft > 0; ++i) {
+        if (i >= skyline.size()) {
+            return std::nullopt;
+        }
+        y = std::max(y, skyline[i].y);
+        if (y + rectSize.y > size.y) {
+            return std::nullopt;
+        }
+        widthLeft -= std::min(widthLeft, skyline[i].width);
+    }
+    return y;
+}
+
+std::optional<sf::Vector2u> AtlasPacker::insert(const sf::Vector2u rectSize) {
+    if (rectSize.x == 0 || rectSize.y == 0) {
+        return sf::Vector2u{0, 0};
+    }
+
+    std::size_t bestIndex = skyline.size();
+    unsigned int bestTop = std::numeric_limits<unsigned int>::max();
+    unsigned int bestWidth = std::numeric_limits<unsigned int>::max();
+
+    for (std::size_t i = 0; i < skyline.size(); ++i) {
+        const auto y = fitHeight(i, rectSize);
+        if (!y) {
+            continue;
+        }
+        const unsigned int top = *y + rectSize.y;
+        if (top < bestTop || (top == bestTop && skyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestTop = top;
+            bestWidth = skyline[i].width;
+        }
+    }
+
+    if (bestIndex == skyline.size()) {
+        return std::nullopt;
+    }
+
+    const sf::Vector2u position{skyline[bestIndex].x, bestTop - rectSize.y};
+    addNode(bestIndex, position, rectSize);
+    usedHeight = std::max(usedHeight, bestTop);
+    usedArea += static_cast<unsigned long long>(rectSize.x) * rectSize.y;
+    return position;
+}
+
+void AtlasPacker::addNode(const std::size_t nodeIndex, const sf::Vector2u position, const sf::Vector2u rectSize) {
+    skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(nodeIndex),
+                   {position.x, position.y + rectSize.y, rectSize.x});
+
+    for (std::size_t i = nodeIndex + 1; i < skyline.size();) {
+        const unsigned int previousEnd = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= previousEnd) {
+            break;
+        }
+        const unsigned int shrink = previousEnd - skyline[i].x;
+        if (skyline[i].width <= shrink) {
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        break;
+    }
+
+    for (std::size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+        } else {
+            ++i;
+        }
+    }
+}
+
+bool AtlasPacker::packAll(const std::vector<sf::Vector2u>& rectSizes, const unsigned int maxSize,
+                          sf::Vector2u& atlasSize, std::vector<sf::Vector2u>& positions) {
+    unsigned long long totalArea = 0;
+    unsigned int minWidth = 1;
+    unsigned int minHeight = 1;
+    for (const auto& rect : rectSizes) {
+        totalArea += static_cast<unsigned long long>(rect.x) * rect.y;
+        minWidth = std::max(minWidth, rect.x);
+        minHeight = std::max(minHeight, rect.y);
+    }
+
+    std::vector<std::size_t> order(rectSizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b) {
+        if (rectSizes[a].y != rectSizes[b].y) {
+            return rectSizes[a].y > rectSizes[b].y;
+        }
+        return rectSizes[a].x > rectSizes[b].x;
+    });
+
+    unsigned int width = 1;
+    while (width < minWidth || static_cast<unsigned long long>(width) * width < totalArea) {
+        width *= 2;
+    }
+    unsigned int height = 1;
+    while (height < minHeight || static_cast<unsigned long long>(width) * height < totalArea) {
+        height *= 2;
+    }
+
+    AtlasPacker packer;
+    std::vector<sf::Vector2u> placed(rectSizes.size());
+    while (width <= maxSize && height <= maxSize) {
+        packer.reset({width, height});
+        bool fits = true;
+        for (const std::size_t index : order) {
+            const auto position = packer.insert(rectSizes[index]);
+            if (!position) {
+                fits = false;
+                break;
+            }
+            placed[index] = *position;
+        }
+
+        if (fits) {
+            atlasSize = {width, height};
+            positions = std::move(placed);
+            return true;
+        }
+
+        if (height < width) {
+            height *= 2;
+        } else {
+            width *= 2;
+        }
+    }
+    return false;
+}
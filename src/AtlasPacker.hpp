@@ -0,0 +1,34 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <optional>
+#include <vector>
+
+class AtlasPacker {
+public:
+    AtlasPacker() = default;
+    explicit AtlasPacker(sf::Vector2u size);
+
+    void reset(sf::Vector2u size);
+    std::optional<sf::Vector2u> insert(sf::Vector2u rectSize);
+    sf::Vector2u getSize() const { return size; }
+    unsigned int getUsedHeight() const { return usedHeight; }
+    unsigned long long getUsedArea() const { return usedArea; }
+
+    static bool packAll(const std::vector<sf::Vector2u>& rectSizes, unsigned int maxSize,
+                        sf::Vector2u& atlasSize, std::vector<sf::Vector2u>& positions);
+
+private:
+    struct SkylineNode {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+    };
+
+    std::optional<unsigned int> fitHeight(std::size_t nodeIndex, sf::Vector2u rectSize) const;
+    void addNode(std::size_t nodeIndex, sf::Vector2u position, sf::Vector2u rectSize);
+
+    sf::Vector2u size;
+    std::vector<SkylineNode> skyline;
+    unsigned int usedHeight{0};
+    unsigned long long usedArea{0};
+};
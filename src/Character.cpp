@@ -1,43 +1,86 @@
 #include "Character.hpp"
 
+#include <algorithm>
 #include <utility>
 
 Character::Character(std::string characterName)
     : name(std::move(characterName))
     , position(0.f, 0.f)
-    , defaultTexture(std::make_unique<sf::Texture>())
-    , sprite(*defaultTexture)
 {
-    defaultTexture->resize({1, 1});
 }
 
-void Character::addExpression(const std::string& expressionName, const sf::Texture& texture) {
-    expressions[expressionName] = texture;
-    if (expressions.size() == 1) {
-        setExpression(expressionName);
+std::size_t Character::addExpression(const std::string& expressionName, TextureCache::Handle texture, const sf::Vector2f textureScale) {
+    const sf::IntRect rect = texture ? sf::IntRect({0, 0}, sf::Vector2i(texture->getSize())) : sf::IntRect();
+    return addExpression(expressionName, std::move(texture), rect, textureScale);
+}
+
+std::size_t Character::addExpression(const std::string& expressionName, TextureCache::Handle texture, const sf::IntRect& rect, const sf::Vector2f textureScale) {
+    const bool first = !sprite && texture;
+    expressions.push_back({expressionName, std::move(texture), rect, textureScale});
+    if (first) {
+        setExpression(expressions.size() - 1);
     }
+    return expressions.size() - 1;
 }
 
 void Character::setExpression(const std::string& expressionName) {
-    if (const auto it = expressions.find(expressionName); it != expressions.end()) {
-        currentSprite = std::make_unique<sf::Sprite>(it->second);
-        currentSprite->setPosition(position);
+    for (std::size_t i = 0; i < expressions.size(); ++i) {
+        if (expressions[i].name == expressionName) {
+            setExpression(i);
+            return;
+        }
+    }
+}
+
+void Character::setExpression(const std::size_t expressionId) {
+    if (expressionId >= expressions.size() || !expressions[expressionId].texture) {
+        return;
     }
+    const Expression& expression = expressions[expressionId];
+    if (!sprite) {
+        sprite.emplace(*expression.texture, expression.rect);
+    } else {
+        if (currentTexture != expression.texture) {
+            sprite->setTexture(*expression.texture);
+        }
+        sprite->setTextureRect(expression.rect);
+    }
+    currentTexture = expression.texture;
+    sprite->setScale({1.0f / expression.textureScale.x, 1.0f / expression.textureScale.y});
+    sprite->setPosition(position);
+    ++version;
+}
+
+void Character::setInitialPosition(const sf::Vector2f& pos) {
+    initialPosition = pos;
+    setPosition(pos);
 }
 
 void Character::setPosition(const sf::Vector2f& pos) {
     position = pos;
-    if (currentSprite) {
-        currentSprite->setPosition(position);
-    } else {
-        sprite.setPosition(position);
+    ++version;
+    if (sprite) {
+        sprite->setPosition(position);
     }
 }
 
-void Character::render(sf::RenderWindow& window) const {
-    if (currentSprite) {
-        window.draw(*currentSprite);
-    } else {
-        window.draw(sprite);
+void Character::render(sf::RenderTarget& window) const {
+    if (sprite) {
+        window.draw(*sprite);
+    }
+}
+
+void Character::capture(RenderSnapshot& snapshot) const {
+    if (sprite) {
+        snapshot.draw(*sprite, currentTexture);
+    }
+}
+
+std::size_t Character::estimateMemoryUsage(TextureCache::CountedTextures& countedTextures) const {
+    std::size_t bytes = sizeof(Character) + name.capacity();
+    for (const auto& expression : expressions) {
+        bytes += sizeof(expression) + expression.name.capacity();
+        bytes += TextureCache::countTexture(expression.texture.get(), countedTextures);
     }
+    return bytes;
 }
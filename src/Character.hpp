@@ -1,10 +1,13 @@
 #pragma once
-#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Sprite.hpp>
 #include <SFML/Graphics/Texture.hpp>
+#include <optional>
 #include <string>
-#include <map>
+#include <vector>
 #include <memory>
+#include "RenderSnapshot.hpp"
+#include "TextureCache.hpp"
 
 class Character {
 public:
@@ -16,18 +19,33 @@ public:
     Character(Character&&) noexcept = default;
     Character& operator=(Character&&) noexcept = default;
 
-    void addExpression(const std::string& expressionName, const sf::Texture& texture);
+    std::size_t addExpression(const std::string& expressionName, TextureCache::Handle texture, sf::Vector2f textureScale = {1.0f, 1.0f});
+    std::size_t addExpression(const std::string& expressionName, TextureCache::Handle texture, const sf::IntRect& rect, sf::Vector2f textureScale = {1.0f, 1.0f});
     void setExpression(const std::string& expressionName);
+    void setExpression(std::size_t expressionId);
     void setPosition(const sf::Vector2f& pos);
-    void render(sf::RenderWindow& window) const;
+    void setInitialPosition(const sf::Vector2f& pos);
+    void resetPosition() { setPosition(initialPosition); }
+    void render(sf::RenderTarget& window) const;
+    void capture(RenderSnapshot& snapshot) const;
     const std::string& getName() const { return name; }
     const sf::Vector2f& getPosition() const { return position; }
+    std::uint64_t getVersion() const { return version; }
+    std::size_t estimateMemoryUsage(TextureCache::CountedTextures& countedTextures) const;
 
 private:
     std::string name;
     sf::Vector2f position;
-    std::unique_ptr<sf::Texture> defaultTexture;
-    sf::Sprite sprite;
-    std::unique_ptr<sf::Sprite> currentSprite;
-    std::map<std::string, sf::Texture> expressions;
+    sf::Vector2f initialPosition;
+    std::optional<sf::Sprite> sprite;
+    TextureCache::Handle currentTexture;
+    std::uint64_t version{0};
+    struct Expression {
+        std::string name;
+        TextureCache::Handle texture;
+        sf::IntRect rect;
+        sf::Vector2f textureScale{1.0f, 1.0f};
+    };
+
+    std::vector<Expression> expressions;
 };
\ No newline at end of file
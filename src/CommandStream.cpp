@@ -0,0 +1,252 @@
+#include "CommandStream.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+void CommandStream::clear() {
+    ops.clear();
+    dialogs.clear();
+    moves.clear();
+    music.clear();
+    sfx.clear();
+    arena.clear();
+    names.clear();
+    firstIndex = 0;
+}
+
+void CommandStream::reserve(const std::size_t count) {
+    ops.reserve(count);
+}
+
+void CommandStream::assign(const std::vector<ScriptCommand>& commands) {
+    clear();
+    reserve(commands.size());
+    for (const auto& cmd : commands) {
+        append(cmd);
+    }
+    shrinkToFit();
+}
+
+void CommandStream::shrinkToFit() {
+    ops.shrink_to_fit();
+    dialogs.shrink_to_fit();
+    moves.shrink_to_fit();
+    music.shrink_to_fit();
+    sfx.shrink_to_fit();
+    arena.shrink_to_fit();
+}
+
+void CommandStream::discardBefore(const std::size_t index) {
+    if (index <= firstIndex) {
+        return;
+    }
+
+    const std::size_t dropped = std::min(index, getEndIndex()) - firstIndex;
+    ops.erase(ops.begin(), ops.begin() + static_cast<std::ptrdiff_t>(dropped));
+    firstIndex = index;
+
+    std::array<std::size_t, 4> first{dialogs.size(), moves.size(), music.size(), sfx.size()};
+    for (const Op& op : ops) {
+        first[op.type] = std::min<std::size_t>(first[op.type], op.payload);
+    }
+    for (Op& op : ops) {
+        op.payload -= static_cast<std::uint32_t>(first[op.type]);
+    }
+    const auto eraseFront = [](auto& payloads, const std::size_t count) {
+        payloads.erase(payloads.begin(), payloads.begin() + static_cast<std::ptrdiff_t>(count));
+    };
+    eraseFront(dialogs, first[ScriptCommand::DIALOG]);
+    eraseFront(moves, first[ScriptCommand::MOVE]);
+    eraseFront(music, first[ScriptCommand::MUSIC]);
+    eraseFront(sfx, first[ScriptCommand::SFX]);
+
+    std::string previous;
+    previous.swap(arena);
+    names.clear();
+    std::unordered_map<std::uint32_t, StringRef> movedNames;
+    const auto moveString = [&](StringRef& ref) {
+        ref = addString(std::string_view(previous).substr(ref.offset, ref.length));
+    };
+    const auto moveName = [&](StringRef& ref) {
+        if (ref.length == 0) {
+            return;
+        }
+        const auto [moved, inserted] = movedNames.try_emplace(ref.offset);
+        if (inserted) {
+            moved->second = addString(std::string_view(previous).substr(ref.offset, ref.length));
+            names.emplace(std::string(getString(moved->second)), moved->second);
+        }
+        ref = moved->second;
+    };
+    for (auto& dialog : dialogs) {
+        moveName(dialog.character);
+        moveString(dialog.text);
+        moveName(dialog.expression);
+    }
+    for (auto& move : moves) {
+        moveName(move.character);
+    }
+    for (auto& track : music) {
+        moveName(track.track);
+    }
+    for (auto& effect : sfx) {
+        moveName(effect.sound);
+    }
+}
+
+CommandStream::StringRef CommandStream::addString(const std::string_view str) {
+    const StringRef ref{static_cast<std::uint32_t>(arena.size()), static_cast<std::uint32_t>(str.size())};
+    arena += str;
+    return ref;
+}
+
+CommandStream::StringRef CommandStream::addName(const std::string& name) {
+    if (name.empty()) {
+        return {};
+    }
+    if (const auto found = names.find(name); found != names.end()) {
+        return found->second;
+    }
+    const StringRef ref = addString(name);
+    names.emplace(name, ref);
+    return ref;
+}
+
+std::uint32_t CommandStream::payloadIndex(const std::size_t count) {
+    if (count >= MAX_PAYLOADS) {
+        throw std::length_error("script has more than 16777216 commands of one type");
+    }
+    return static_cast<std::uint32_t>(count);
+}
+
+void CommandStream::append(const ScriptCommand& cmd) {
+    Op op{};
+    op.type = static_cast<std::uint32_t>(cmd.type);
+
+    switch (cmd.type) {
+        case ScriptCommand::DIALOG: {
+            op.payload = payloadIndex(dialogs.size());
+            DialogCommand dialog;
+            dialog.character = addName(cmd.character);
+            dialog.text = addString(cmd.text);
+            dialog.expression = addName(cmd.expression);
+            dialog.characterId = cmd.characterId;
+            dialog.expressionId = cmd.expressionId;
+            dialogs.push_back(dialog);
+            break;
+        }
+
+        case ScriptCommand::MOVE: {
+            op.payload = payloadIndex(moves.size());
+            MoveCommand move;
+            move.character = addName(cmd.character);
+            move.position = cmd.position;
+            move.duration = cmd.duration;
+            move.characterId = cmd.characterId;
+            move.smooth = cmd.smooth;
+            moves.push_back(move);
+            break;
+        }
+
+        case ScriptCommand::MUSIC: {
+            op.payload = payloadIndex(music.size());
+            MusicCommand track;
+            track.track = addName(cmd.musicName);
+            track.volume = cmd.volume;
+            track.fadeInTime = cmd.fadeInTime;
+            track.fadeOutTime = cmd.fadeOutTime;
+            track.trackId = cmd.trackId;
+            track.loop = cmd.loop;
+            music.push_back(track);
+            break;
+        }
+
+        case ScriptCommand::SFX: {
+            op.payload = payloadIndex(sfx.size());
+            SfxCommand effect;
+            effect.sound = addName(cmd.soundName);
+            effect.volume = cmd.volume;
+            effect.soundId = cmd.soundId;
+            effect.priority = cmd.priority;
+            sfx.push_back(effect);
+            break;
+        }
+    }
+
+    ops.push_back(op);
+}
+
+ScriptCommand CommandStream::toCommand(const std::size_t index) const {
+    ScriptCommand cmd;
+    cmd.type = getType(index);
+
+    switch (cmd.type) {
+        case ScriptCommand::DIALOG: {
+            const DialogCommand& dialog = getDialog(index);
+            cmd.character = getString(dialog.character);
+            cmd.text = getString(dialog.text);
+            cmd.expression = getString(dialog.expression);
+            cmd.characterId = dialog.characterId;
+            cmd.expressionId = dialog.expressionId;
+            break;
+        }
+
+        case ScriptCommand::MOVE: {
+            const MoveCommand& move = getMove(index);
+            cmd.character = getString(move.character);
+            cmd.position = move.position;
+            cmd.duration = move.duration;
+            cmd.characterId = move.characterId;
+            cmd.smooth = move.smooth;
+            break;
+        }
+
+        case ScriptCommand::MUSIC: {
+            const MusicCommand& track = getMusic(index);
+            cmd.musicName = getString(track.track);
+            cmd.volume = track.volume;
+            cmd.fadeInTime = track.fadeInTime;
+            cmd.fadeOutTime = track.fadeOutTime;
+            cmd.trackId = track.trackId;
+            cmd.loop = track.loop;
+            break;
+        }
+
+        case ScriptCommand::SFX: {
+            const SfxCommand& effect = getSfx(index);
+            cmd.soundName = getString(effect.sound);
+            cmd.volume = effect.volume;
+            cmd.soundId = effect.soundId;
+            cmd.priority = effect.priority;
+            break;
+        }
+    }
+
+    return cmd;
+}
+
+std::size_t CommandStream::getMemoryUsage() const {
+    return sizeof(*this) +
+           ops.capacity() * sizeof(Op) +
+           dialogs.capacity() * sizeof(DialogCommand) +
+           moves.capacity() * sizeof(MoveCommand) +
+           music.capacity() * sizeof(MusicCommand) +
+           sfx.capacity() * sizeof(SfxCommand) +
+           arena.capacity() +
+           names.bucket_count() * sizeof(void*) +
+           names.size() * (sizeof(std::string) + sizeof(StringRef) + 2 * sizeof(void*));
+}
+
+std::size_t CommandStream::estimateMemoryUsage(const std::vector<ScriptCommand>& commands) {
+    const auto heapBytes = [](const std::string& str) -> std::size_t {
+        const std::string empty;
+        return str.capacity() > empty.capacity() ? str.capacity() + 1 : 0;
+    };
+
+    std::size_t bytes = sizeof(commands) + commands.capacity() * sizeof(ScriptCommand);
+    for (const auto& cmd : commands) {
+        bytes += heapBytes(cmd.character) + heapBytes(cmd.text) + heapBytes(cmd.expression) + heapBytes(cmd.musicName) +
+                 heapBytes(cmd.soundName);
+    }
+    return bytes;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ScriptCommand.hpp"
+
+class CommandStream {
+public:
+    struct StringRef {
+        std::uint32_t offset{0};
+        std::uint32_t length{0};
+    };
+
+    struct DialogCommand {
+        StringRef character;
+        StringRef text;
+        StringRef expression;
+        std::int32_t characterId{ScriptCommand::NONE};
+        std::int32_t expressionId{ScriptCommand::NONE};
+    };
+
+    struct MoveCommand {
+        StringRef character;
+        sf::Vector2f position;
+        float duration{0.0f};
+        std::int32_t characterId{ScriptCommand::NONE};
+        bool smooth{true};
+    };
+
+    struct MusicCommand {
+        StringRef track;
+        float volume{100.0f};
+        float fadeInTime{0.0f};
+        float fadeOutTime{0.0f};
+        std::int32_t trackId{ScriptCommand::NONE};
+        bool loop{false};
+    };
+
+    struct SfxCommand {
+        StringRef sound;
+        float volume{100.0f};
+        std::int32_t soundId{ScriptCommand::NONE};
+        std::int32_t priority{0};
+    };
+
+    void clear();
+    void reserve(std::size_t count);
+    void append(const ScriptCommand& cmd);
+    void assign(const std::vector<ScriptCommand>& commands);
+    void shrinkToFit();
+    void discardBefore(std::size_t index);
+
+    std::size_t size() const { return ops.size(); }
+    bool empty() const { return ops.empty(); }
+    std::size_t getFirstIndex() const { return firstIndex; }
+    std::size_t getEndIndex() const { return firstIndex + ops.size(); }
+    ScriptCommand::Type getType(std::size_t index) const { return static_cast<ScriptCommand::Type>(opAt(index).type); }
+    const DialogCommand& getDialog(std::size_t index) const { return dialogs[opAt(index).payload]; }
+    const MoveCommand& getMove(std::size_t index) const { return moves[opAt(index).payload]; }
+    const MusicCommand& getMusic(std::size_t index) const { return music[opAt(index).payload]; }
+    const SfxCommand& getSfx(std::size_t index) const { return sfx[opAt(index).payload]; }
+    std::string_view getString(StringRef ref) const { return {arena.data() + ref.offset, ref.length}; }
+    ScriptCommand toCommand(std::size_t index) const;
+
+    std::size_t getMemoryUsage() const;
+    static std::size_t estimateMemoryUsage(const std::vector<ScriptCommand>& commands);
+
+private:
+    struct Op {
+        std::uint32_t type : 8;
+        std::uint32_t payload : 24;
+    };
+
+    static constexpr std::size_t MAX_PAYLOADS = std::size_t{1} << 24;
+    static std::uint32_t payloadIndex(std::size_t count);
+
+    const Op& opAt(std::size_t index) const { return ops[index - firstIndex]; }
+    StringRef addString(std::string_view str);
+    StringRef addName(const std::string& name);
+
+    std::vector<Op> ops;
+    std::vector<DialogCommand> dialogs;
+    std::vector<MoveCommand> moves;
+    std::vector<MusicCommand> music;
+    std::vector<SfxCommand> sfx;
+    std::string arena;
+    std::unordered_map<std::string, StringRef> names;
+    std::size_t firstIndex{0};
+};
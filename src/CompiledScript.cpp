@@ -0,0 +1,427 @@
+#include "CompiledScript.hpp"
+#include "AssetPack.hpp"
+#include "MappedFile.hpp"
+#include "Hash.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr char MAGIC[4] = {'V', 'N', 'S', 'C'};
+
+    struct FileHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t sourceSize;
+        std::int64_t sourceModified;
+        std::uint64_t sourceHash;
+        std::uint32_t sceneName;
+        std::uint32_t backgroundPath;
+        std::uint32_t nextScenePath;
+        std::uint32_t fontPath;
+        std::uint32_t flags;
+        std::uint32_t stringCount;
+        std::uint32_t characterCount;
+        std::uint32_t spriteCount;
+        std::uint32_t musicCount;
+        std::uint32_t soundCount;
+        std::uint32_t commandCount;
+        std::uint32_t stringTableOffset;
+        std::uint32_t stringDataOffset;
+        std::uint32_t stringDataSize;
+        std::uint32_t characterOffset;
+        std::uint32_t spriteOffset;
+        std::uint32_t musicOffset;
+        std::uint32_t soundOffset;
+        std::uint32_t commandOffset;
+    };
+
+    struct StringEntry {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    struct CharacterRecord {
+        std::uint32_t name;
+        std::uint32_t firstSprite;
+        std::uint32_t spriteCount;
+        float x;
+        float y;
+    };
+
+    struct SpriteRecord {
+        std::uint32_t expression;
+        std::uint32_t path;
+    };
+
+    struct MusicRecord {
+        std::uint32_t name;
+        std::uint32_t path;
+        std::uint32_t loop;
+    };
+
+    struct SoundRecord {
+        std::uint32_t name;
+        std::uint32_t path;
+    };
+
+    enum SceneFlags : std::uint32_t {
+        SCENE_KEEP_RESIDENT = 1u << 0
+    };
+
+    enum CommandFlags : std::uint32_t {
+        COMMAND_SMOOTH = 1u << 0,
+        COMMAND_LOOP = 1u << 1
+    };
+
+    struct CommandRecord {
+        std::uint32_t type;
+        std::uint32_t flags;
+        std::uint32_t character;
+        std::uint32_t text;
+        std::uint32_t expression;
+        std::uint32_t musicName;
+        std::uint32_t soundName;
+        std::int32_t priority;
+        float x;
+        float y;
+        float duration;
+        float volume;
+        float fadeIn;
+        float fadeOut;
+    };
+
+    static_assert(sizeof(CommandRecord) == 56, "command records must stay fixed-size");
+
+    std::uint32_t alignOffset(const std::size_t offset) {
+        return static_cast<std::uint32_t>((offset + 7) & ~static_cast<std::size_t>(7));
+    }
+
+    class StringTable {
+    public:
+        StringTable() { add(""); }
+
+        std::uint32_t add(const std::string& str) {
+            if (const auto it = ids.find(str); it != ids.end()) {
+                return it->second;
+            }
+            const auto id = static_cast<std::uint32_t>(entries.size());
+            entries.push_back({static_cast<std::uint32_t>(bytes.size()), static_cast<std::uint32_t>(str.size())});
+            bytes += str;
+            ids.emplace(str, id);
+            return id;
+        }
+
+        const std::vector<StringEntry>& getEntries() const { return entries; }
+        const std::string& getBytes() const { return bytes; }
+
+    private:
+        std::unordered_map<std::string, std::uint32_t> ids;
+        std::vector<StringEntry> entries;
+        std::string bytes;
+    };
+
+    template <typename T>
+    void appendSection(std::vector<char>& out, std::uint32_t& offset, const std::vector<T>& records) {
+        out.resize(alignOffset(out.size()), 0);
+        offset = static_cast<std::uint32_t>(out.size());
+        const auto* begin = reinterpret_cast<const char*>(records.data());
+        out.insert(out.end(), begin, begin + records.size() * sizeof(T));
+    }
+
+    bool readHeader(const AssetPack::Blob& file, FileHeader& header) {
+        if (!file || file.size < sizeof(FileHeader)) {
+            return false;
+        }
+        std::memcpy(&header, file.data, sizeof(header));
+        return std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == CompiledScript::VERSION;
+    }
+
+    bool sourceMatches(const FileHeader& header, const std::string& scriptPath) {
+        if (const AssetPack::Blob source = AssetPack::getInstance().find(scriptPath)) {
+            return source.size == header.sourceSize && hashBytes(source.data, source.size) == header.sourceHash;
+        }
+
+        std::error_code ec;
+        if (!std::filesystem::exists(scriptPath, ec)) {
+            return true;
+        }
+
+        const auto size = std::filesystem::file_size(scriptPath, ec);
+        if (ec || size != header.sourceSize) {
+            return false;
+        }
+
+        const auto modified = std::filesystem::last_write_time(scriptPath, ec);
+        if (!ec && static_cast<std::int64_t>(modified.time_since_epoch().count()) == header.sourceModified) {
+            return true;
+        }
+
+        CompiledScript::SourceStamp stamp;
+        return CompiledScript::stampSource(scriptPath, stamp) && stamp.hash == header.sourceHash;
+    }
+
+    AssetPack::Blob mapCompiled(const std::string& compiledPath, MappedFile& mapped) {
+        if (const AssetPack::Blob blob = AssetPack::getInstance().find(compiledPath)) {
+            return blob;
+        }
+        std::error_code ec;
+        if (!std::filesystem::exists(compiledPath, ec) || !mapped.open(compiledPath)) {
+            return {};
+        }
+        return {mapped.getData(), mapped.getSize()};
+    }
+
+    template <typename T>
+    const T* readSection(const AssetPack::Blob& file, const std::uint32_t offset, const std::uint32_t count) {
+        if (offset % alignof(T) != 0 || offset > file.size ||
+            static_cast<std::uint64_t>(count) * sizeof(T) > file.size - offset) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T*>(file.data + offset);
+    }
+}
+
+std::string CompiledScript::compiledPathFor(const std::string& scriptPath) {
+    std::filesystem::path path(scriptPath);
+    path.replace_extension(EXTENSION);
+    return path.string();
+}
+
+bool CompiledScript::stampSource(const std::string& scriptPath, SourceStamp& stamp) {
+    std::ifstream file(scriptPath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::error_code ec;
+    const auto modified = std::filesystem::last_write_time(scriptPath, ec);
+    stamp.size = contents.size();
+    stamp.modified = ec ? 0 : static_cast<std::int64_t>(modified.time_since_epoch().count());
+    stamp.hash = hashBytes(contents.data(), contents.size());
+    return true;
+}
+
+bool CompiledScript::compile(const std::string& scriptPath, const std::string& outputPath) {
+    ScriptData data;
+    try {
+        data = ScriptParser::parseScript(scriptPath);
+    } catch (const YAML::Exception& e) {
+        std::cerr << "Failed to parse script " << scriptPath << ": " << e.what() << std::endl;
+        return false;
+    }
+    return compile(scriptPath, data, outputPath);
+}
+
+bool CompiledScript::compile(const std::string& scriptPath, const ScriptData& data, const std::string& outputPath) {
+    SourceStamp stamp;
+    if (!stampSource(scriptPath, stamp)) {
+        std::cerr << "Failed to read script: " << scriptPath << std::endl;
+        return false;
+    }
+    for (const auto& error : data.errors) {
+        std::cerr << scriptPath << ": " << error << std::endl;
+    }
+    return write(data, stamp, outputPath);
+}
+
+bool CompiledScript::write(const ScriptData& data, const SourceStamp& stamp, const std::string& outputPath) {
+    StringTable strings;
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sourceSize = stamp.size;
+    header.sourceModified = stamp.modified;
+    header.sourceHash = stamp.hash;
+    header.sceneName = strings.add(data.sceneName);
+    header.backgroundPath = strings.add(data.backgroundPath);
+    header.nextScenePath = strings.add(data.nextScenePath);
+    header.fontPath = strings.add(data.fontPath);
+    header.flags = data.keepResident ? SCENE_KEEP_RESIDENT : 0u;
+
+    std::vector<CharacterRecord> characters;
+    std::vector<SpriteRecord> sprites;
+    for (const auto& [name, charData] : data.characterData) {
+        CharacterRecord record{};
+        record.name = strings.add(name);
+        record.firstSprite = static_cast<std::uint32_t>(sprites.size());
+        record.spriteCount = static_cast<std::uint32_t>(charData.sprites.size());
+        record.x = charData.initial_position.x;
+        record.y = charData.initial_position.y;
+        for (const auto& [expression, path] : charData.sprites) {
+            sprites.push_back({strings.add(expression), strings.add(path)});
+        }
+        characters.push_back(record);
+    }
+
+    std::vector<MusicRecord> music;
+    for (const auto& [name, musicData] : data.musicTracks) {
+        music.push_back({strings.add(name), strings.add(musicData.path), musicData.loop ? 1u : 0u});
+    }
+
+    std::vector<SoundRecord> sounds;
+    for (const auto& [name, soundData] : data.sounds) {
+        sounds.push_back({strings.add(name), strings.add(soundData.path)});
+    }
+
+    std::vector<CommandRecord> commands;
+    commands.reserve(data.commands.size());
+    for (std::size_t i = 0; i < data.commands.size(); ++i) {
+        const ScriptCommand cmd = data.commands.toCommand(i);
+        CommandRecord record{};
+        record.type = static_cast<std::uint32_t>(cmd.type);
+        record.flags = (cmd.smooth ? COMMAND_SMOOTH : 0u) | (cmd.loop ? COMMAND_LOOP : 0u);
+        record.character = strings.add(cmd.character);
+        record.text = strings.add(cmd.text);
+        record.expression = strings.add(cmd.expression);
+        record.musicName = strings.add(cmd.musicName);
+        record.soundName = strings.add(cmd.soundName);
+        record.priority = cmd.priority;
+        record.x = cmd.position.x;
+        record.y = cmd.position.y;
+        record.duration = cmd.duration;
+        record.volume = cmd.volume;
+        record.fadeIn = cmd.fadeInTime;
+        record.fadeOut = cmd.fadeOutTime;
+        commands.push_back(record);
+    }
+
+    header.stringCount = static_cast<std::uint32_t>(strings.getEntries().size());
+    header.characterCount = static_cast<std::uint32_t>(characters.size());
+    header.spriteCount = static_cast<std::uint32_t>(sprites.size());
+    header.musicCount = static_cast<std::uint32_t>(music.size());
+    header.soundCount = static_cast<std::uint32_t>(sounds.size());
+    header.commandCount = static_cast<std::uint32_t>(commands.size());
+
+    std::vector<char> out(sizeof(FileHeader), 0);
+    appendSection(out, header.stringTableOffset, strings.getEntries());
+    appendSection(out, header.characterOffset, characters);
+    appendSection(out, header.spriteOffset, sprites);
+    appendSection(out, header.musicOffset, music);
+    appendSection(out, header.soundOffset, sounds);
+    appendSection(out, header.commandOffset, commands);
+    header.stringDataOffset = static_cast<std::uint32_t>(out.size());
+    header.stringDataSize = static_cast<std::uint32_t>(strings.getBytes().size());
+    out.insert(out.end(), strings.getBytes().begin(), strings.getBytes().end());
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        std::cerr << "Failed to write compiled script: " << outputPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool CompiledScript::isUpToDate(const std::string& compiledPath, const std::string& scriptPath) {
+    MappedFile mapped;
+    FileHeader header{};
+    return readHeader(mapCompiled(compiledPath, mapped), header) && sourceMatches(header, scriptPath);
+}
+
+bool CompiledScript::load(const std::string& compiledPath, const std::string& scriptPath, ScriptData& data) {
+    MappedFile mapped;
+    const AssetPack::Blob file = mapCompiled(compiledPath, mapped);
+    FileHeader header{};
+    if (!readHeader(file, header) || !sourceMatches(header, scriptPath)) {
+        return false;
+    }
+
+    const auto* entries = readSection<StringEntry>(file, header.stringTableOffset, header.stringCount);
+    const auto* characters = readSection<CharacterRecord>(file, header.characterOffset, header.characterCount);
+    const auto* sprites = readSection<SpriteRecord>(file, header.spriteOffset, header.spriteCount);
+    const auto* music = readSection<MusicRecord>(file, header.musicOffset, header.musicCount);
+    const auto* sounds = readSection<SoundRecord>(file, header.soundOffset, header.soundCount);
+    const auto* commands = readSection<CommandRecord>(file, header.commandOffset, header.commandCount);
+    const auto* stringData = readSection<char>(file, header.stringDataOffset, header.stringDataSize);
+    if (!entries || !characters || !sprites || !music || !sounds || !commands || !stringData) {
+        std::cerr << "Corrupt compiled script: " << compiledPath << std::endl;
+        return false;
+    }
+
+    bool valid = true;
+    const auto str = [&](const std::uint32_t id) -> std::string {
+        if (id >= header.stringCount ||
+            static_cast<std::uint64_t>(entries[id].offset) + entries[id].length > header.stringDataSize) {
+            valid = false;
+            return {};
+        }
+        return {stringData + entries[id].offset, entries[id].length};
+    };
+
+    ScriptData result;
+    result.sceneName = str(header.sceneName);
+    result.backgroundPath = str(header.backgroundPath);
+    result.nextScenePath = str(header.nextScenePath);
+    result.fontPath = str(header.fontPath);
+    result.keepResident = (header.flags & SCENE_KEEP_RESIDENT) != 0;
+
+    for (std::uint32_t i = 0; i < header.characterCount; ++i) {
+        const CharacterRecord& record = characters[i];
+        if (static_cast<std::uint64_t>(record.firstSprite) + record.spriteCount > header.spriteCount) {
+            valid = false;
+            break;
+        }
+        ScriptData::CharacterData charData;
+        for (std::uint32_t s = 0; s < record.spriteCount; ++s) {
+            const SpriteRecord& sprite = sprites[record.firstSprite + s];
+            charData.sprites[str(sprite.expression)] = str(sprite.path);
+        }
+        charData.initial_position = sf::Vector2f(record.x, record.y);
+        result.characterData[str(record.name)] = std::move(charData);
+    }
+
+    for (std::uint32_t i = 0; i < header.musicCount; ++i) {
+        ScriptData::MusicData musicData;
+        musicData.path = str(music[i].path);
+        musicData.loop = music[i].loop != 0;
+        result.musicTracks[str(music[i].name)] = std::move(musicData);
+    }
+
+    for (std::uint32_t i = 0; i < header.soundCount; ++i) {
+        ScriptData::SoundData soundData;
+        soundData.path = str(sounds[i].path);
+        result.sounds[str(sounds[i].name)] = std::move(soundData);
+    }
+
+    std::vector<ScriptCommand> commandList;
+    commandList.reserve(header.commandCount);
+    for (std::uint32_t i = 0; i < header.commandCount; ++i) {
+        const CommandRecord& record = commands[i];
+        if (record.type > ScriptCommand::SFX) {
+            valid = false;
+            break;
+        }
+        ScriptCommand cmd;
+        cmd.type = static_cast<ScriptCommand::Type>(record.type);
+        cmd.character = str(record.character);
+        cmd.text = str(record.text);
+        cmd.expression = str(record.expression);
+        cmd.musicName = str(record.musicName);
+        cmd.soundName = str(record.soundName);
+        cmd.priority = record.priority;
+        cmd.position = sf::Vector2f(record.x, record.y);
+        cmd.duration = record.duration;
+        cmd.smooth = (record.flags & COMMAND_SMOOTH) != 0;
+        cmd.loop = (record.flags & COMMAND_LOOP) != 0;
+        cmd.volume = record.volume;
+        cmd.fadeInTime = record.fadeIn;
+        cmd.fadeOutTime = record.fadeOut;
+        commandList.push_back(std::move(cmd));
+    }
+
+    if (!valid) {
+        std::cerr << "Corrupt compiled script: " << compiledPath << std::endl;
+        return false;
+    }
+
+    ScriptParser::resolveReferences(result, commandList, 0, result.errors);
+    result.commands.assign(commandList);
+    data = std::move(result);
+    return true;
+}
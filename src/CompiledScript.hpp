@@ -0,0 +1,25 @@
+#pragma once
+#include "ScriptParser.hpp"
+#include <cstdint>
+#include <string>
+
+class CompiledScript {
+public:
+    static constexpr std::uint32_t VERSION = 3;
+    static constexpr const char* EXTENSION = ".vnsc";
+
+    struct SourceStamp {
+        std::uint64_t size{0};
+        std::int64_t modified{0};
+        std::uint64_t hash{0};
+    };
+
+    static std::string compiledPathFor(const std::string& scriptPath);
+    static bool compile(const std::string& scriptPath, const std::string& outputPath);
+    static bool compile(const std::string& scriptPath, const ScriptData& data, const std::string& outputPath);
+    static bool write(const ScriptData& data, const SourceStamp& stamp, const std::string& outputPath);
+    static bool isUpToDate(const std::string& compiledPath, const std::string& scriptPath);
+    static bool load(const std::string& compiledPath, const std::string& scriptPath, ScriptData& data);
+
+    static bool stampSource(const std::string& scriptPath, SourceStamp& stamp);
+};
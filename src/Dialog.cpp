@@ -1,10 +1,11 @@
 #include "Dialog.hpp"
 #include "FontGenerator.hpp"
+#include "Profiler.hpp"
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Graphics/Text.hpp>
 #include <iostream>
-#include <codecvt>
 #include <vector>
+#include <algorithm>
 
 Dialog::Dialog()
     : currentLine(0)
@@ -14,8 +15,6 @@ Dialog::Dialog()
     , advanceCooldown(0.2f)
     , isTextBoxVisible(false)
 {
-    initializeFont();
-
     textRenderStates = sf::RenderStates::Default;
     textRenderStates.texture = &FontGenerator::getInstance().getTexture();
 
@@ -28,73 +27,40 @@ Dialog::Dialog()
     nameBox.setFillColor(sf::Color(0, 0, 0, 200));
 }
 
-void Dialog::initializeFont() {
-    if (!FontGenerator::getInstance().generateBitmapFont("assets/resources/fonts/NotoSans.ttf", 24)) {
-        std::cerr << "Failed to generate bitmap font" << std::endl;
-    }
+void Dialog::addLine(const std::string& line) {
+    textLayout.layout(line, MAX_LINE_WIDTH, LINE_HEIGHT);
+    showLine(line, textLayout.getSlice());
 }
 
-void Dialog::addLine(const std::string& line) {
-    bool wasVisible = !dialogLine.isEmpty();
-    
-    clearText();
-    
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
-    std::u32string utf32 = converter.from_bytes(line);
-    fullDialogLine = sf::String(utf32);
-    
-    if (!validateString(fullDialogLine)) {
+void Dialog::addLine(const std::string& line, const std::size_t preparedKey) {
+    const std::optional<TextLayout::Slice> slice = preparedLines.find(preparedKey);
+    if (!slice) {
+        addLine(line);
         return;
     }
+    FontGenerator::getInstance().warmGlyphs(slice->text);
+    showLine(line, *slice);
+}
 
-    sf::String currentLine;
-    sf::String currentWord;
-    float lineWidth = 0.0f;
-    float wordWidth = 0.0f;
-
-    for (size_t i = 0; i < fullDialogLine.getSize(); ++i) {
-        uint32_t c = fullDialogLine[i];
-        const auto* glyphInfo = FontGenerator::getInstance().getGlyphInfo(c);
-        if (!glyphInfo) continue;
-
-        if (c == ' ' || c == '\n') {
-            if (lineWidth + wordWidth > MAX_LINE_WIDTH) {
-                wrappedLines.push_back(currentLine);
-                currentLine = currentWord;
-                lineWidth = wordWidth;
-            } else {
-                currentLine += currentWord;
-                lineWidth += wordWidth;
-            }
-            
-            if (c == ' ' && lineWidth + glyphInfo->advance <= MAX_LINE_WIDTH) {
-                currentLine += sf::String({static_cast<wchar_t>(c)});
-                lineWidth += glyphInfo->advance;
-            }
-            if (c == '\n') {
-                wrappedLines.push_back(currentLine);
-                currentLine.clear();
-                lineWidth = 0;
-            }
-            currentWord.clear();
-            wordWidth = 0;
-        } else {
-            currentWord += sf::String({static_cast<wchar_t>(c)});
-            wordWidth += glyphInfo->advance;
-        }
-    }
+void Dialog::prepareLines(const std::vector<std::pair<std::size_t, std::string_view>>& lines) {
+    preparedLines.build(lines, MAX_LINE_WIDTH, LINE_HEIGHT);
+}
 
-    if (!currentWord.isEmpty()) {
-        if (lineWidth + wordWidth > MAX_LINE_WIDTH) {
-            wrappedLines.push_back(currentLine);
-            wrappedLines.push_back(currentWord);
-        } else {
-            currentLine += currentWord;
-            wrappedLines.push_back(currentLine);
-        }
-    } else if (!currentLine.isEmpty()) {
-        wrappedLines.push_back(currentLine);
+void Dialog::showLine(const std::string& line, const TextLayout::Slice& slice) {
+    bool wasVisible = revealedChars > 0;
+
+    revealedChars = 0;
+    textBatches.clear();
+    glyphBatches.clear();
+    isAnimating = false;
+    timeSinceLastChar = 0.0f;
+
+    dialogText = line;
+    if (slice.isEmpty()) {
+        return;
     }
+
+    layoutText(slice);
     
     isAnimating = true;
     timeSinceLastChar = 0.0f;
@@ -103,6 +69,7 @@ void Dialog::addLine(const std::string& line) {
 }
 
 void Dialog::update(const float deltaTime) {
+    VN_PROFILE_SCOPE("Dialog::update");
     if (!isAnimating) {
         if (advanceTimer < advanceCooldown) {
             advanceTimer += deltaTime;
@@ -114,82 +81,57 @@ void Dialog::update(const float deltaTime) {
     if (timeSinceLastChar >= characterDelay) {
         timeSinceLastChar = 0.0f;
 
-        if (dialogLine.getSize() < fullDialogLine.getSize()) {
-            dialogLine += fullDialogLine[dialogLine.getSize()];
+        if (revealedChars < glyphBatches.size()) {
+            revealGlyphs(revealedChars + 1);
         } else {
             isAnimating = false;
         }
     }
 }
 
-void Dialog::updateTextVertices() {
-    textVertices.clear();
-    if (dialogLine.isEmpty()) {
-        return;
+void Dialog::layoutText(const TextLayout::Slice& slice) {
+    textBatches.clear();
+    glyphBatches.clear();
+
+    const FontGenerator& fontGenerator = FontGenerator::getInstance();
+    for (size_t r = 0; r < slice.runCount; ++r) {
+        const TextLayout::Run& run = slice.runs[r];
+        for (size_t i = run.first; i < run.first + run.count; ++i) {
+            const TextLayout::Glyph& glyph = slice.glyphs[i];
+            int batch = -1;
+            if (const auto* glyphInfo = fontGenerator.getGlyphInfo(glyph.codepoint)) {
+                batch = appendGlyphQuad(textBatches, *glyphInfo, TEXT_ORIGIN + glyph.position, run.color);
+            }
+            glyphBatches.push_back(batch);
+        }
     }
+}
 
-    size_t totalChars = 0;
-    size_t currentLineIndex = 0;
-    
-    for (const auto& line : wrappedLines) {
-        constexpr float startY = 545.f;
-        constexpr float startX = 140.f;
-        float x = startX;
-        float y = startY + (LINE_HEIGHT * currentLineIndex);
-
-        for (size_t i = 0; i < line.getSize() && totalChars < dialogLine.getSize(); ++i, ++totalChars) {
-            constexpr float scale = 1.0f;
-            uint32_t c = line[i];
-            const auto* glyphInfo = FontGenerator::getInstance().getGlyphInfo(c);
-            if (!glyphInfo) continue;
-            
-            TextVertex vertex;
-            float xOffset = glyphInfo->offset.x * scale;
-            float yOffset = glyphInfo->offset.y * scale;
-            float left = x + xOffset;
-            float top = y + yOffset;
-            float right = left + glyphInfo->size.x * scale;
-            float bottom = top + glyphInfo->size.y * scale;
-            
-            const sf::Texture& texture = FontGenerator::getInstance().getTexture();
-            float texLeft = glyphInfo->texCoords.x / static_cast<float>(texture.getSize().x);
-            float texRight = texLeft + (glyphInfo->size.x / static_cast<float>(texture.getSize().x));
-            float texTop = glyphInfo->texCoords.y / static_cast<float>(texture.getSize().y);
-            float texBottom = texTop + (glyphInfo->size.y / static_cast<float>(texture.getSize().y));
-            
-            if (!validateTextureCoords(texLeft, texTop) || 
-                !validateTextureCoords(texRight, texBottom)) {
-                continue;
-            }
-            
-            for (auto & vertice : vertex.vertices) {
-                vertice.color = sf::Color::White;
-            }
-            
-            vertex.vertices[0].position = sf::Vector2f(left, top);
-            vertex.vertices[0].texCoords = sf::Vector2f(texLeft, texTop);
-            
-            vertex.vertices[1].position = sf::Vector2f(right, top);
-            vertex.vertices[1].texCoords = sf::Vector2f(texRight, texTop);
-            
-            vertex.vertices[2].position = sf::Vector2f(left, bottom);
-            vertex.vertices[2].texCoords = sf::Vector2f(texLeft, texBottom);
-            
-            vertex.vertices[3].position = sf::Vector2f(right, top);
-            vertex.vertices[3].texCoords = sf::Vector2f(texRight, texTop);
-            
-            vertex.vertices[4].position = sf::Vector2f(right, bottom);
-            vertex.vertices[4].texCoords = sf::Vector2f(texRight, texBottom);
-            
-            vertex.vertices[5].position = sf::Vector2f(left, bottom);
-            vertex.vertices[5].texCoords = sf::Vector2f(texLeft, texBottom);
-            
-            textVertices.push_back(vertex);
-            x += glyphInfo->advance * scale;
+void Dialog::revealGlyphs(const size_t count) {
+    for (size_t i = revealedChars; i < std::min(count, glyphBatches.size()); ++i) {
+        if (glyphBatches[i] >= 0) {
+            textBatches[glyphBatches[i]].visibleVertices += 6;
         }
-        
-        currentLineIndex++;
     }
+    revealedChars = count;
+}
+
+void Dialog::refreshLayout() {
+    const size_t revealed = revealedChars;
+    textLayout.decode(dialogText);
+    nameLayout.decode(characterName);
+    std::u32string glyphs(textLayout.getText());
+    glyphs += nameLayout.getText();
+    FontGenerator::getInstance().warmGlyphs(std::u32string_view(glyphs));
+
+    textLayout.reflow(MAX_LINE_WIDTH, LINE_HEIGHT);
+    layoutText(textLayout.getSlice());
+    revealedChars = 0;
+    revealGlyphs(revealed);
+    nameLayout.reflow();
+    updateNameVertices();
+
+    layoutEpoch = FontGenerator::getInstance().getLayoutEpoch();
 }
 
 bool Dialog::isAnimationComplete() const {
@@ -200,198 +142,116 @@ bool Dialog::canAdvance() const {
     return !isAnimating && advanceTimer >= advanceCooldown;
 }
 
-void Dialog::render(sf::RenderWindow& window) {
+template <typename Target>
+void Dialog::drawTo(Target& target) {
     try {
-        if (isTextBoxVisible) {
-            if (!characterName.isEmpty()) {
-                window.draw(nameBox);
-                
-                const sf::Texture& texture = FontGenerator::getInstance().getTexture();
-                if (texture.getSize().x == 0 || texture.getSize().y == 0) return;
-                
-                sf::RenderStates states;
-                states.texture = &texture;
-                states.blendMode = sf::BlendAlpha;
-
-                auto x = 160.f;
-                auto y = 520.f;
-                
-                for (size_t i = 0; i < characterName.getSize(); ++i) {
-                    uint32_t c = characterName[i];
-                    const auto* glyphInfo = FontGenerator::getInstance().getGlyphInfo(c);
-                    if (!glyphInfo) continue;
-
-                    sf::Sprite sprite(texture);
-                    
-                    sf::IntRect textureRect(
-                        sf::Vector2i(
-                            static_cast<int>(glyphInfo->texCoords.x * texture.getSize().x),
-                            static_cast<int>(glyphInfo->texCoords.y * texture.getSize().y)
-                        ),
-                        sf::Vector2i(
-                            static_cast<int>(glyphInfo->size.x),
-                            static_cast<int>(glyphInfo->size.y)
-                        )
-                    );
-                    sprite.setTextureRect(textureRect);
-                    sprite.setPosition(sf::Vector2f(
-                        x + glyphInfo->offset.x,
-                        y + glyphInfo->offset.y
-                    ));
-                    
-                    window.draw(sprite, states);
-                    x += glyphInfo->advance;
-                }
-            }
+        if (!isTextBoxVisible) return;
 
-            window.draw(textBox);
-            updateTextVertices();
-            
-            if (textVertices.empty()) return;
-            
-            const sf::Texture& texture = FontGenerator::getInstance().getTexture();
-            if (texture.getSize().x == 0 || texture.getSize().y == 0) return;
-            
-            textRenderStates.texture = &texture;
-            textRenderStates.blendMode = sf::BlendAlpha;
-            
-            for (const auto& vertex : textVertices) {
-                window.draw(vertex.vertices, 6, sf::PrimitiveType::Triangles, textRenderStates);
-            }
-            
-            sf::RenderStates states;
-            states.texture = &texture;
-            states.blendMode = sf::BlendAlpha;
-
-            float startX = 140.f;
-            float startY = 560.f;
-            size_t totalChars = 0;
-            size_t currentLineIndex = 0;
-            
-            for (const auto& line : wrappedLines) {
-                float x = startX;
-                float y = startY + (currentLineIndex * LINE_HEIGHT);
-                
-                for (size_t i = 0; i < line.getSize() && totalChars < dialogLine.getSize(); ++i, ++totalChars) {
-                    uint32_t c = line[i];
-                    const auto* glyphInfo = FontGenerator::getInstance().getGlyphInfo(c);
-                    if (!glyphInfo) continue;
-
-                    sf::Sprite sprite(texture);
-                    
-                    sf::IntRect textureRect(
-                        sf::Vector2i(
-                            static_cast<int>(glyphInfo->texCoords.x * texture.getSize().x),
-                            static_cast<int>(glyphInfo->texCoords.y * texture.getSize().y)
-                        ),
-                        sf::Vector2i(
-                            static_cast<int>(glyphInfo->size.x),
-                            static_cast<int>(glyphInfo->size.y)
-                        )
-                    );
-                    sprite.setTextureRect(textureRect);
-                    
-                    sprite.setPosition(sf::Vector2f(
-                        x + glyphInfo->offset.x,
-                        y + glyphInfo->offset.y
-                    ));
-                    
-                    window.draw(sprite);
-                    x += glyphInfo->advance;
-                }
-                
-                currentLineIndex++;
-            }
+        if (layoutEpoch != FontGenerator::getInstance().getLayoutEpoch()) {
+            refreshLayout();
         }
+
+        if (!nameLayout.isEmpty()) {
+            target.draw(nameBox);
+            drawBatches(target, nameBatches);
+        }
+
+        target.draw(textBox);
+        drawBatches(target, textBatches);
     } catch (const std::exception& e) {
         std::cerr << "Error in render: " << e.what() << "\n";
     }
 }
 
+template <typename Target>
+void Dialog::drawBatches(Target& target, const std::vector<TextBatch>& batches) {
+    textRenderStates.blendMode = sf::BlendAlpha;
+    for (const auto& batch : batches) {
+        const sf::Texture& texture = FontGenerator::getInstance().getPageTexture(batch.page);
+        if (batch.visibleVertices == 0 || texture.getSize().x == 0 || texture.getSize().y == 0) {
+            continue;
+        }
+        textRenderStates.texture = &texture;
+        target.draw(&batch.vertices[0], batch.visibleVertices, sf::PrimitiveType::Triangles, textRenderStates);
+    }
+}
+
+void Dialog::render(sf::RenderTarget& window) {
+    VN_PROFILE_SCOPE("Dialog::render");
+    drawTo(window);
+}
+
+void Dialog::capture(RenderSnapshot& snapshot) {
+    drawTo(snapshot);
+}
+
 void Dialog::completeAnimation() {
     if (isAnimating) {
-        dialogLine = fullDialogLine;
+        revealGlyphs(glyphBatches.size());
         isAnimating = false;
         advanceTimer = 0.0f;
-        isTextBoxVisible = !dialogLine.isEmpty();
+        isTextBoxVisible = revealedChars > 0;
     }
 }
 
 void Dialog::setCharacterName(const std::string& name) {
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
-    std::u32string utf32 = converter.from_bytes(name);
-    characterName = sf::String(utf32);
-
-    float nameWidth = 0.f;
-    for (size_t i = 0; i < characterName.getSize(); ++i) {
-        uint32_t c = characterName[i];
-        const auto* glyphInfo = FontGenerator::getInstance().getGlyphInfo(c);
-        if (glyphInfo) {
-            nameWidth += glyphInfo->advance;
-        }
-    }
-
-    const float PADDING = 20.f;
-    nameWidth += PADDING * 2;
-
-    nameBox.setSize(sf::Vector2f(nameWidth, 40.f));
+    characterName = name;
+    nameLayout.layout(characterName);
+    nameBox.setSize(sf::Vector2f(nameLayout.getWidth() + NAME_PADDING * 2, 40.f));
     
     updateNameVertices();
 }
 
 void Dialog::updateNameVertices() {
-    nameVertices.clear();
-    if (characterName.isEmpty()) return;
-
-    const float PADDING = 20.f;
-    float startX = nameBox.getPosition().x + PADDING;
-    float startY = nameBox.getPosition().y + (nameBox.getSize().y - 24.f) / 2;
-    const float scale = 1.0f;
-    float x = startX;
-
-    for (size_t i = 0; i < characterName.getSize(); ++i) {
-        const unsigned c = characterName[i];
-        const auto* glyphInfo = FontGenerator::getInstance().getGlyphInfo(c);
-        if (!glyphInfo) continue;
-
-        TextVertex vertex;
-        float xOffset = glyphInfo->offset.x * scale;
-        float yOffset = glyphInfo->offset.y * scale;
-        float left = x + xOffset;
-        float top = startY + yOffset;
-        float right = left + glyphInfo->size.x * scale;
-        float bottom = top + glyphInfo->size.y * scale;
-
-        const sf::Texture& texture = FontGenerator::getInstance().getTexture();
-        float texLeft = glyphInfo->texCoords.x / texture.getSize().x;
-        float texRight = texLeft + (glyphInfo->size.x / texture.getSize().x);
-        float texTop = glyphInfo->texCoords.y / texture.getSize().y;
-        float texBottom = texTop + (glyphInfo->size.y / texture.getSize().y);
-
-        for (int v = 0; v < 6; ++v) {
-            vertex.vertices[v].color = sf::Color::White;
+    nameBatches.clear();
+
+    const FontGenerator& fontGenerator = FontGenerator::getInstance();
+    const sf::Vector2f origin(nameBox.getPosition().x + NAME_PADDING, nameBox.getPosition().y + NAME_BASELINE);
+    const auto& glyphs = nameLayout.getGlyphs();
+    for (const auto& run : nameLayout.getRuns()) {
+        for (size_t i = run.first; i < run.first + run.count; ++i) {
+            if (const auto* glyphInfo = fontGenerator.getGlyphInfo(glyphs[i].codepoint)) {
+                appendGlyphQuad(nameBatches, *glyphInfo, origin + glyphs[i].position, run.color);
+            }
         }
-        
-        vertex.vertices[0].position = sf::Vector2f(left, top);
-        vertex.vertices[0].texCoords = sf::Vector2f(texLeft, texTop);
-        
-        vertex.vertices[1].position = sf::Vector2f(right, top);
-        vertex.vertices[1].texCoords = sf::Vector2f(texRight, texTop);
-        
-        vertex.vertices[2].position = sf::Vector2f(left, bottom);
-        vertex.vertices[2].texCoords = sf::Vector2f(texLeft, texBottom);
-        
-        vertex.vertices[3].position = sf::Vector2f(right, top);
-        vertex.vertices[3].texCoords = sf::Vector2f(texRight, texTop);
-        
-        vertex.vertices[4].position = sf::Vector2f(right, bottom);
-        vertex.vertices[4].texCoords = sf::Vector2f(texRight, texBottom);
-        
-        vertex.vertices[5].position = sf::Vector2f(left, bottom);
-        vertex.vertices[5].texCoords = sf::Vector2f(texLeft, texBottom);
-
-        nameVertices.push_back(vertex);
-        x += glyphInfo->advance * scale;
+    }
+
+    for (auto& batch : nameBatches) {
+        batch.visibleVertices = batch.vertices.getVertexCount();
     }
 }
 
+int Dialog::appendGlyphQuad(std::vector<TextBatch>& batches, const FontGenerator::GlyphInfo& glyphInfo, const sf::Vector2f pen, const sf::Color color) {
+    if (!validateTextureCoords(glyphInfo.texCoords.x, glyphInfo.texCoords.y)) {
+        return -1;
+    }
+
+    auto batch = std::find_if(batches.begin(), batches.end(), [&](const TextBatch& candidate) {
+        return candidate.page == glyphInfo.page;
+    });
+    if (batch == batches.end()) {
+        batches.push_back(TextBatch{glyphInfo.page});
+        batch = batches.end() - 1;
+    }
+    sf::VertexArray& vertices = batch->vertices;
+
+    const sf::Vector2u textureSize = FontGenerator::getInstance().getPageTexture(glyphInfo.page).getSize();
+    const float texLeft = glyphInfo.texCoords.x * static_cast<float>(textureSize.x);
+    const float texTop = glyphInfo.texCoords.y * static_cast<float>(textureSize.y);
+    const float texRight = texLeft + glyphInfo.size.x;
+    const float texBottom = texTop + glyphInfo.size.y;
+
+    const float left = pen.x + glyphInfo.offset.x;
+    const float top = pen.y + glyphInfo.offset.y;
+    const float right = left + glyphInfo.size.x;
+    const float bottom = top + glyphInfo.size.y;
+
+    vertices.append({{left, top}, color, {texLeft, texTop}});
+    vertices.append({{right, top}, color, {texRight, texTop}});
+    vertices.append({{left, bottom}, color, {texLeft, texBottom}});
+    vertices.append({{right, top}, color, {texRight, texTop}});
+    vertices.append({{right, bottom}, color, {texRight, texBottom}});
+    vertices.append({{left, bottom}, color, {texLeft, texBottom}});
+
+    return static_cast<int>(batch - batches.begin());
+}
@@ -1,13 +1,14 @@
 #pragma once
-#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include <string>
 #include <memory>
-#include <codecvt>
 #include <iostream>
-#include <locale>
+#include "FontGenerator.hpp"
+#include "RenderSnapshot.hpp"
+#include "TextLayout.hpp"
 
 namespace sf {
     class Font;
@@ -19,7 +20,11 @@ public:
     Dialog();
 
     void addLine(const std::string& line);
-    void render(sf::RenderWindow& window);
+    void addLine(const std::string& line, std::size_t preparedKey);
+    void prepareLines(const std::vector<std::pair<std::size_t, std::string_view>>& lines);
+    std::size_t getPreparedMemoryUsage() const { return preparedLines.getMemoryUsage(); }
+    void render(sf::RenderTarget& window);
+    void capture(RenderSnapshot& snapshot);
     void update(float deltaTime);
     bool isAnimationComplete() const;
     void completeAnimation();
@@ -35,74 +40,67 @@ public:
     void setCharacterName(const std::string& name);
 
     void clearText() {
-        dialogLine.clear();
-        fullDialogLine.clear();
-        wrappedLines.clear();
+        revealedChars = 0;
+        dialogText.clear();
+        textLayout.clear();
+        textBatches.clear();
+        glyphBatches.clear();
         isAnimating = false;
         timeSinceLastChar = 0.0f;
     }
 
 private:
-    struct TextVertex {
-        sf::Vertex vertices[6];
+    struct TextBatch {
+        unsigned int page{0};
+        sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+        size_t visibleVertices{0};
     };
 
-    std::vector<TextVertex> textVertices;
+    std::vector<TextBatch> textBatches;
+    std::vector<int> glyphBatches;
     sf::RenderStates textRenderStates;
-    void updateTextVertices();
+    std::uint64_t layoutEpoch{0};
+    void showLine(const std::string& line, const TextLayout::Slice& slice);
+    void layoutText(const TextLayout::Slice& slice);
+    void revealGlyphs(size_t count);
+    void refreshLayout();
+    template <typename Target>
+    void drawTo(Target& target);
+    template <typename Target>
+    void drawBatches(Target& target, const std::vector<TextBatch>& batches);
 
     size_t currentLine;
     std::vector<std::string> dialogLines;
-    sf::String dialogLine;
+    size_t revealedChars{0};
     std::unique_ptr<sf::Font> font;
     std::unique_ptr<sf::Text> text;
     sf::RectangleShape textBox;
-    sf::String fullDialogLine;
+    std::string dialogText;
+    TextLayout textLayout;
+    TextLayoutBatch preparedLines;
     float characterDelay{0.03f};
     float timeSinceLastChar{0.0f};
     bool isAnimating{false};
     float advanceCooldown{0.3f};
     float advanceTimer{0.0f};
 
-    static void initializeFont();
-
     const float MAX_LINE_WIDTH = 980.0f;
     const float LINE_HEIGHT = 30.0f;
-    std::vector<sf::String> wrappedLines;
+    const sf::Vector2f TEXT_ORIGIN{140.f, 560.f};
+    const float NAME_PADDING = 20.f;
+    const float NAME_BASELINE = 30.f;
 
     sf::RectangleShape nameBox;
-    sf::String characterName;
-    std::vector<TextVertex> nameVertices;
+    std::string characterName;
+    TextLayout nameLayout;
+    std::vector<TextBatch> nameBatches;
     void updateNameVertices();
+    static int appendGlyphQuad(std::vector<TextBatch>& batches, const FontGenerator::GlyphInfo& glyphInfo, sf::Vector2f pen, sf::Color color);
 
     bool isTextBoxVisible{false};
 
-    static bool validateString(const sf::String& str) {
-        if (str.isEmpty()) {
-            return false;
-        }
-
-        for (std::size_t i = 0; i < str.getSize(); ++i) {
-            uint32_t c = str[i];
-            if (c < 32 && c != '\n') {
-                return false;
-            }
-        }
-        
-        return str.getSize() < 1000;
-    }
-
     static bool validateTextureCoords(const float x, const float y) {
         return x >= 0.0f && x <= 1.0f && 
                y >= 0.0f && y <= 1.0f;
     }
-
-    static void debugTextureCoords(const TextVertex& vertex) {
-        std::cout << "Texture coordinates:\n";
-        for (int i = 0; i < 6; ++i) {
-            std::cout << "Vertex " << i << ": ("
-                     << vertex.vertices[i].texCoords.x << ", "
-                     << vertex.vertices[i].texCoords.y << ")\n";
-        }
-    }
 };
\ No newline at end of file
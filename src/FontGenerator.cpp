@@ -1,127 +1,583 @@
 #include "FontGenerator.hpp"
+#include "AssetPack.hpp"
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <thread>
 #include <vector>
 #include <iostream>
 
+namespace {
+    constexpr char ATLAS_MAGIC[4] = {'V', 'N', 'F', 'A'};
+    constexpr std::uint32_t ATLAS_VERSION = 2;
+    constexpr unsigned int GLYPH_PADDING = 1;
+    constexpr std::size_t FONT_RESET_THRESHOLD = 512;
+
+    struct AtlasHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t sourceSize;
+        std::int64_t sourceModified;
+        std::uint32_t fontSize;
+        float lineHeight;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t glyphCount;
+        std::uint32_t kerningCount;
+    };
+
+    struct GlyphRecord {
+        std::uint32_t codepoint;
+        float texX;
+        float texY;
+        float width;
+        float height;
+        float advance;
+        float offsetX;
+        float offsetY;
+    };
+
+    struct KerningRecord {
+        std::uint32_t first;
+        std::uint32_t second;
+        float amount;
+    };
+
+    std::uint64_t kerningKey(const std::uint32_t first, const std::uint32_t second) {
+        return (static_cast<std::uint64_t>(first) << 32) | second;
+    }
+}
+
+const FontGenerator::GlyphRanges FontGenerator::DEFAULT_RANGES = {
+    {32, 126},
+    {1024, 1279}
+};
+
 FontGenerator& FontGenerator::getInstance() {
     static FontGenerator instance;
     return instance;
 }
 
+FontGenerator::~FontGenerator() {
+    for (const auto& [key, atlas] : atlases) {
+        if (atlas->kerningDirty && !atlas->cachePath.empty()) {
+            saveKerning(*atlas);
+        }
+    }
+}
+
 bool FontGenerator::generateBitmapFont(const std::string& ttfPath, unsigned int fontSize) {
-    sf::Font ttfFont;
-    if (!ttfFont.openFromFile(ttfPath)) {
+    return generateBitmapFont(ttfPath, fontSize, DEFAULT_RANGES);
+}
+
+bool FontGenerator::generateBitmapFont(const std::string& ttfPath, unsigned int fontSize, const GlyphRanges& ranges) {
+    const std::string key = makeKey(ttfPath, fontSize, ranges);
+    if (const auto it = atlases.find(key); it != atlases.end()) {
+        if (activeAtlas != it->second.get()) {
+            activeAtlas = it->second.get();
+            ++layoutEpoch;
+        }
+        return true;
+    }
+
+    SourceStamp stamp;
+    if (!stampSource(ttfPath, stamp)) {
         std::cerr << "Failed to load TTF font: " << ttfPath << std::endl;
         return false;
     }
 
-    std::vector<std::pair<uint32_t, uint32_t>> ranges = {
-        {32, 126},
-        {1024, 1279}
-    };
+    auto atlas = std::make_unique<Atlas>();
+    const std::string cachePath = cachePathFor(key);
+    if (loadCachedAtlas(cachePath, stamp, fontSize, *atlas)) {
+        atlas->cachePath = cachePath;
+    } else {
+        if (!rasterize(ttfPath, fontSize, ranges, *atlas)) {
+            return false;
+        }
+        if (saveCachedAtlas(cachePath, stamp, fontSize, *atlas)) {
+            atlas->cachePath = cachePath;
+        }
+    }
 
-    constexpr unsigned int padding = 2;
-    unsigned int maxGlyphHeight = 0;
-    unsigned int totalWidth = padding;
-    std::vector<sf::Glyph> glyphs;
+    atlas->ttfPath = ttfPath;
+    atlas->fontSize = fontSize;
+    activeAtlas = atlas.get();
+    ++layoutEpoch;
+    atlases[key] = std::move(atlas);
+    return true;
+}
 
+std::string FontGenerator::makeKey(const std::string& ttfPath, unsigned int fontSize, const GlyphRanges& ranges) {
+    std::ostringstream key;
+    key << std::filesystem::path(ttfPath).lexically_normal().generic_string() << '|' << fontSize;
+    for (const auto& [first, last] : ranges) {
+        key << '|' << first << '-' << last;
+    }
+    return key.str();
+}
+
+bool FontGenerator::stampSource(const std::string& ttfPath, SourceStamp& stamp) {
+    if (const AssetPack::Blob packed = AssetPack::getInstance().find(ttfPath)) {
+        stamp.size = packed.size;
+        stamp.modified = static_cast<std::int64_t>(hashBytes(packed.data, packed.size));
+        return true;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(ttfPath, ec);
+    if (ec) {
+        return false;
+    }
+    const auto modified = std::filesystem::last_write_time(ttfPath, ec);
+    stamp.size = size;
+    stamp.modified = ec ? 0 : static_cast<std::int64_t>(modified.time_since_epoch().count());
+    return true;
+}
+
+std::string FontGenerator::cachePathFor(const std::string& key) const {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hashString(key) << ".vnfont";
+    return (std::filesystem::path(cacheDirectory) / name.str()).string();
+}
+
+bool FontGenerator::rasterize(const std::string& ttfPath, unsigned int fontSize, const GlyphRanges& ranges, Atlas& atlas) {
+    std::vector<uint32_t> codepoints;
     for (const auto& range : ranges) {
         for (uint32_t c = range.first; c <= range.second; ++c) {
-            try {
-                sf::Glyph glyph = ttfFont.getGlyph(c, fontSize, false);
-                float glyphWidth = glyph.bounds.size.x;
-                float glyphHeight = glyph.bounds.size.y;
-                maxGlyphHeight = std::max(maxGlyphHeight, static_cast<unsigned>(glyphHeight + padding * 2));
-                totalWidth += static_cast<unsigned>(glyphWidth + padding * 2);
-                glyphs.push_back(glyph);
-            } catch (const std::exception& e) {
-                std::cerr << "Failed to get glyph " << c << ": " << e.what() << "\n";
-            }
+            codepoints.push_back(c);
         }
     }
 
-    unsigned int texWidth = 1;
-    while (texWidth < totalWidth) texWidth *= 2;
-    unsigned int texHeight = 1;
-    while (texHeight < maxGlyphHeight) texHeight *= 2;
-    
-    renderTex = sf::RenderTexture(sf::Vector2u{texWidth, texHeight});
-    if (!renderTex.setActive()) {
-        std::cerr << "Failed to create render texture" << std::endl;
-        return false;
+    constexpr std::size_t glyphsPerThread = 64;
+    const std::size_t threadCount = std::clamp<std::size_t>(
+        std::thread::hardware_concurrency(), 1, std::max<std::size_t>(1, codepoints.size() / glyphsPerThread));
+
+    std::vector<RasterBatch> batches(threadCount);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threadCount; ++t) {
+        workers.emplace_back(rasterizeBatch, std::cref(ttfPath), fontSize, std::cref(codepoints), t, threadCount, std::ref(batches[t]));
+    }
+    rasterizeBatch(ttfPath, fontSize, codepoints, 0, threadCount, batches[0]);
+    for (auto& worker : workers) {
+        worker.join();
     }
 
-    if (renderTex.getSize().x == 0 || renderTex.getSize().y == 0) {
-        std::cerr << "RenderTexture has invalid size!" << std::endl;
+    std::vector<sf::Vector2u> rectSizes;
+    for (const auto& batch : batches) {
+        if (!batch.loaded) {
+            std::cerr << "Failed to load TTF font: " << ttfPath << std::endl;
+            return false;
+        }
+        for (const auto& [codepoint, glyph] : batch.glyphs) {
+            const bool empty = glyph.textureRect.size.x <= 0 || glyph.textureRect.size.y <= 0;
+            rectSizes.push_back(empty ? sf::Vector2u{0, 0} : sf::Vector2u(glyph.textureRect.size) + sf::Vector2u{GLYPH_PADDING * 2, GLYPH_PADDING * 2});
+        }
+    }
+
+    sf::Vector2u atlasSize;
+    std::vector<sf::Vector2u> positions;
+    if (!AtlasPacker::packAll(rectSizes, sf::Texture::getMaximumSize(), atlasSize, positions)) {
+        std::cerr << "Glyphs for " << ttfPath << " at size " << fontSize << " do not fit in one texture" << std::endl;
         return false;
     }
 
-    renderTex.clear(sf::Color::Transparent);
-    
-    float currentX = padding;
-    float currentY = padding;
-    size_t glyphIndex = 0;
-    
-    for (const auto& range : ranges) {
-        for (uint32_t c = range.first; c <= range.second; ++c) {
-            if (glyphIndex >= glyphs.size()) {
-                std::cerr << "Glyph index out of bounds!\n";
-                continue;
+    sf::Image image(atlasSize, sf::Color::Transparent);
+    std::size_t rectIndex = 0;
+    for (const auto& batch : batches) {
+        for (const auto& [codepoint, glyph] : batch.glyphs) {
+            const sf::Vector2u position = positions[rectIndex] + sf::Vector2u{GLYPH_PADDING, GLYPH_PADDING};
+            if (rectSizes[rectIndex++].x > 0 && !image.copy(batch.page, position, glyph.textureRect)) {
+                std::cerr << "Failed to copy glyph " << codepoint << " into atlas\n";
             }
-            
-            const sf::Glyph& glyph = glyphs[glyphIndex++];
-            
-            sf::Sprite glyphSprite(ttfFont.getTexture(fontSize));
-            glyphSprite.setTextureRect(glyph.textureRect);
-            glyphSprite.setPosition(sf::Vector2f{currentX, currentY});
-            glyphSprite.setColor(sf::Color::White);
-            
-            renderTex.draw(glyphSprite);
 
             GlyphInfo info;
             info.texCoords = sf::Vector2f(
-                static_cast<float>(currentX) / texWidth,
-                static_cast<float>(currentY) / texHeight
+                static_cast<float>(position.x) / static_cast<float>(atlasSize.x),
+                static_cast<float>(position.y) / static_cast<float>(atlasSize.y)
             );
-            float glyphWidth = glyph.bounds.size.x;
-            float glyphHeight = glyph.bounds.size.y;
-            info.size = sf::Vector2f(glyphWidth, glyphHeight);
+            info.size = glyph.bounds.size;
             info.advance = glyph.advance;
-            info.offset = sf::Vector2f(glyph.bounds.position.x, glyph.bounds.position.y);
-            
-            glyphMap[c] = info;
-
-            currentX += glyphWidth + padding;
-            if (currentX + glyphWidth + padding > texWidth) {
-                currentX = padding;
-                currentY += maxGlyphHeight + padding;
-                if (currentY + maxGlyphHeight + padding > texHeight) {
-                    std::cerr << "Not enough texture height to place all glyphs.\n";
-                    return false;
-                }
-            }
+            info.offset = glyph.bounds.position;
+            atlas.glyphMap[codepoint] = info;
         }
     }
 
-    renderTex.display();
-    
-    if (!renderTex.setActive() || renderTex.getSize().x == 0 || renderTex.getSize().y == 0) {
-        std::cerr << "RenderTexture is invalid after creation!" << std::endl;
+    if (!atlas.texture.loadFromImage(image)) {
+        std::cerr << "Failed to create valid font texture!\n";
         return false;
     }
-    
-    fontTexture = renderTex.getTexture();
-    if (fontTexture.getSize().x == 0 || fontTexture.getSize().y == 0) {
-        std::cerr << "Failed to create valid font texture!\n";
+
+    atlas.lineHeight = batches[0].lineHeight;
+    return true;
+}
+
+void FontGenerator::rasterizeBatch(const std::string& ttfPath, unsigned int fontSize, const std::vector<uint32_t>& codepoints,
+                                   const std::size_t first, const std::size_t stride, RasterBatch& batch) {
+    sf::Font ttfFont;
+    if (!AssetPack::getInstance().openFont(ttfPath, ttfFont)) {
+        return;
+    }
+
+    for (std::size_t i = first; i < codepoints.size(); i += stride) {
+        batch.glyphs.emplace_back(codepoints[i], ttfFont.getGlyph(codepoints[i], fontSize, false));
+    }
+
+    batch.page = ttfFont.getTexture(fontSize).copyToImage();
+    batch.lineHeight = ttfFont.getLineSpacing(fontSize);
+    batch.loaded = true;
+}
+
+bool FontGenerator::loadCachedAtlas(const std::string& cachePath, const SourceStamp& stamp, unsigned int fontSize, Atlas& atlas) {
+    MappedFile file;
+    if (!file.open(cachePath) || file.getSize() < sizeof(AtlasHeader)) {
         return false;
     }
-    
-    refreshTexture();
-    lineHeight = ttfFont.getLineSpacing(fontSize);
-    
+
+    AtlasHeader header{};
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC)) != 0 || header.version != ATLAS_VERSION ||
+        header.sourceSize != stamp.size || header.sourceModified != stamp.modified || header.fontSize != fontSize) {
+        return false;
+    }
+
+    const std::uint64_t pixelCount = static_cast<std::uint64_t>(header.width) * header.height;
+    const std::uint64_t kerningOffset = sizeof(AtlasHeader) + static_cast<std::uint64_t>(header.glyphCount) * sizeof(GlyphRecord) + pixelCount;
+    const std::uint64_t expectedSize = kerningOffset + static_cast<std::uint64_t>(header.kerningCount) * sizeof(KerningRecord);
+    if (header.width == 0 || header.height == 0 || expectedSize != file.getSize()) {
+        std::cerr << "Ignoring corrupt font cache: " << cachePath << std::endl;
+        return false;
+    }
+
+    const char* cursor = file.getData() + sizeof(AtlasHeader);
+    for (std::uint32_t i = 0; i < header.glyphCount; ++i, cursor += sizeof(GlyphRecord)) {
+        GlyphRecord record{};
+        std::memcpy(&record, cursor, sizeof(record));
+
+        GlyphInfo info;
+        info.texCoords = sf::Vector2f(record.texX, record.texY);
+        info.size = sf::Vector2f(record.width, record.height);
+        info.advance = record.advance;
+        info.offset = sf::Vector2f(record.offsetX, record.offsetY);
+        atlas.glyphMap[record.codepoint] = info;
+    }
+
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(pixelCount) * 4, 255);
+    for (std::size_t i = 0; i < pixelCount; ++i) {
+        pixels[i * 4 + 3] = static_cast<std::uint8_t>(cursor[i]);
+    }
+    cursor += pixelCount;
+    for (std::uint32_t i = 0; i < header.kerningCount; ++i, cursor += sizeof(KerningRecord)) {
+        KerningRecord record{};
+        std::memcpy(&record, cursor, sizeof(record));
+        atlas.kerning.emplace(kerningKey(record.first, record.second), record.amount);
+    }
+    atlas.kerningOffset = kerningOffset;
+
+    const sf::Image image({header.width, header.height}, pixels.data());
+    if (!atlas.texture.loadFromImage(image)) {
+        return false;
+    }
+    atlas.lineHeight = header.lineHeight;
     return true;
 }
 
+bool FontGenerator::saveCachedAtlas(const std::string& cachePath, const SourceStamp& stamp, unsigned int fontSize, Atlas& atlas) {
+    const sf::Image image = atlas.texture.copyToImage();
+    const sf::Vector2u size = image.getSize();
+    if (size.x == 0 || size.y == 0) {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), ec);
+
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to write font cache: " << cachePath << std::endl;
+        return false;
+    }
+
+    AtlasHeader header{};
+    std::memcpy(header.magic, ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+    header.version = ATLAS_VERSION;
+    header.sourceSize = stamp.size;
+    header.sourceModified = stamp.modified;
+    header.fontSize = fontSize;
+    header.lineHeight = atlas.lineHeight;
+    header.width = size.x;
+    header.height = size.y;
+    header.glyphCount = static_cast<std::uint32_t>(atlas.glyphMap.size());
+    header.kerningCount = 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& [codepoint, info] : atlas.glyphMap) {
+        const GlyphRecord record{codepoint, info.texCoords.x, info.texCoords.y, info.size.x, info.size.y,
+                                 info.advance, info.offset.x, info.offset.y};
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+
+    const std::size_t pixelCount = static_cast<std::size_t>(size.x) * size.y;
+    const std::uint8_t* pixels = image.getPixelsPtr();
+    std::vector<char> alpha(pixelCount);
+    for (std::size_t i = 0; i < pixelCount; ++i) {
+        alpha[i] = static_cast<char>(pixels[i * 4 + 3]);
+    }
+    file.write(alpha.data(), static_cast<std::streamsize>(alpha.size()));
+
+    atlas.kerningOffset = sizeof(AtlasHeader) + static_cast<std::uint64_t>(header.glyphCount) * sizeof(GlyphRecord) + pixelCount;
+    return static_cast<bool>(file);
+}
+
+bool FontGenerator::saveKerning(const Atlas& atlas) {
+    std::fstream file(atlas.cachePath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) {
+        std::cerr << "Failed to update font cache: " << atlas.cachePath << std::endl;
+        return false;
+    }
+
+    const auto count = static_cast<std::uint32_t>(atlas.kerning.size());
+    file.seekp(static_cast<std::streamoff>(offsetof(AtlasHeader, kerningCount)));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    file.seekp(static_cast<std::streamoff>(atlas.kerningOffset));
+    for (const auto& [key, amount] : atlas.kerning) {
+        const KerningRecord record{static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(key), amount};
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    return static_cast<bool>(file);
+}
+
 const FontGenerator::GlyphInfo* FontGenerator::getGlyphInfo(uint32_t charcode) const {
-    const auto it = glyphMap.find(charcode);
-    return it != glyphMap.end() ? &it->second : nullptr;
+    if (!activeAtlas) {
+        return nullptr;
+    }
+    const auto it = activeAtlas->glyphMap.find(charcode);
+    return it != activeAtlas->glyphMap.end() ? &it->second : nullptr;
+}
+
+const sf::Texture& FontGenerator::getPageTexture(unsigned int page) const {
+    if (!activeAtlas) {
+        return emptyTexture;
+    }
+    if (page == 0) {
+        return activeAtlas->texture;
+    }
+    return page <= activeAtlas->pages.size() ? activeAtlas->pages[page - 1]->target.getTexture() : emptyTexture;
+}
+
+void FontGenerator::warmGlyphs(const sf::String& text) {
+    warmGlyphs(std::u32string_view(text.getData(), text.getSize()));
+}
+
+void FontGenerator::warmGlyphs(const std::u32string_view text) {
+    if (!activeAtlas) {
+        return;
+    }
+
+    std::lock_guard lock(pageMutex);
+    Atlas& atlas = *activeAtlas;
+    ++useCounter;
+
+    if (atlas.glyphsSinceFontReset >= FONT_RESET_THRESHOLD) {
+        atlas.font.reset();
+        atlas.glyphsSinceFontReset = 0;
+    }
+
+    std::vector<GlyphPage*> dirtyPages;
+    for (const uint32_t c : text) {
+        if (c < 32) {
+            continue;
+        }
+        if (const auto it = atlas.glyphMap.find(c); it != atlas.glyphMap.end()) {
+            if (it->second.page > 0) {
+                atlas.pages[it->second.page - 1]->lastUsed = useCounter;
+            }
+            continue;
+        }
+        if (!atlas.missingGlyphs.count(c) && rasterizeGlyph(atlas, c, dirtyPages) == RasterResult::NotInFont) {
+            atlas.missingGlyphs.insert(c);
+        }
+    }
+
+    for (GlyphPage* page : dirtyPages) {
+        page->target.display();
+    }
+}
+
+float FontGenerator::getKerning(const uint32_t first, const uint32_t second) {
+    if (!activeAtlas) {
+        return 0.0f;
+    }
+    Atlas& atlas = *activeAtlas;
+    const std::uint64_t key = kerningKey(first, second);
+    if (const auto it = atlas.kerning.find(key); it != atlas.kerning.end()) {
+        return it->second;
+    }
+    const float kerning = openFont(atlas) ? atlas.font->getKerning(first, second, atlas.fontSize) : 0.0f;
+    atlas.kerning.emplace(key, kerning);
+    atlas.kerningDirty = true;
+    return kerning;
+}
+
+std::optional<float> FontGenerator::getAdvance(const uint32_t charcode) {
+    if (!activeAtlas || charcode < 32) {
+        return std::nullopt;
+    }
+    Atlas& atlas = *activeAtlas;
+    if (const auto it = atlas.glyphMap.find(charcode); it != atlas.glyphMap.end()) {
+        return it->second.advance;
+    }
+    if (const auto it = atlas.advances.find(charcode); it != atlas.advances.end()) {
+        return it->second;
+    }
+    if (atlas.missingGlyphs.count(charcode)) {
+        return std::nullopt;
+    }
+    if (!openFont(atlas) || !atlas.font->hasGlyph(charcode)) {
+        atlas.missingGlyphs.insert(charcode);
+        return std::nullopt;
+    }
+    const float advance = atlas.font->getGlyph(charcode, atlas.fontSize, false).advance;
+    ++atlas.glyphsSinceFontReset;
+    atlas.advances.emplace(charcode, advance);
+    return advance;
+}
+
+bool FontGenerator::openFont(Atlas& atlas) {
+    if (!atlas.font && !atlas.fontUnavailable) {
+        atlas.font = std::make_unique<sf::Font>();
+        if (!AssetPack::getInstance().openFont(atlas.ttfPath, *atlas.font)) {
+            std::cerr << "Failed to load TTF font: " << atlas.ttfPath << std::endl;
+            atlas.font.reset();
+            atlas.fontUnavailable = true;
+        }
+    }
+    return atlas.font != nullptr;
+}
+
+FontGenerator::RasterResult FontGenerator::rasterizeGlyph(Atlas& atlas, uint32_t charcode, std::vector<GlyphPage*>& dirtyPages) {
+    if (!openFont(atlas) || !atlas.font->hasGlyph(charcode)) {
+        return RasterResult::NotInFont;
+    }
+
+    const sf::Glyph& glyph = atlas.font->getGlyph(charcode, atlas.fontSize, false);
+    ++atlas.glyphsSinceFontReset;
+
+    const bool empty = glyph.textureRect.size.x <= 0 || glyph.textureRect.size.y <= 0;
+    const sf::Vector2u rectSize = empty ? sf::Vector2u{0, 0}
+                                        : sf::Vector2u(glyph.textureRect.size) + sf::Vector2u{GLYPH_PADDING * 2, GLYPH_PADDING * 2};
+
+    GlyphInfo info;
+    info.size = glyph.bounds.size;
+    info.advance = glyph.advance;
+    info.offset = glyph.bounds.position;
+
+    if (!empty) {
+        sf::Vector2u position;
+        GlyphPage* page = allocateGlyph(atlas, rectSize, position);
+        if (!page) {
+            std::cerr << "No glyph page space left for character " << charcode << "\n";
+            return RasterResult::NoSpace;
+        }
+        position += sf::Vector2u{GLYPH_PADDING, GLYPH_PADDING};
+
+        sf::Sprite glyphSprite(atlas.font->getTexture(atlas.fontSize), glyph.textureRect);
+        glyphSprite.setPosition(sf::Vector2f(position));
+        page->target.draw(glyphSprite, sf::RenderStates(sf::BlendNone));
+        page->glyphs.push_back(charcode);
+        page->lastUsed = useCounter;
+        if (std::find(dirtyPages.begin(), dirtyPages.end(), page) == dirtyPages.end()) {
+            dirtyPages.push_back(page);
+        }
+
+        info.page = page->number;
+        info.texCoords = sf::Vector2f(position) / static_cast<float>(DYNAMIC_PAGE_SIZE);
+    }
+
+    atlas.glyphMap[charcode] = info;
+    return RasterResult::Rasterized;
+}
+
+FontGenerator::GlyphPage* FontGenerator::allocateGlyph(Atlas& atlas, sf::Vector2u rectSize, sf::Vector2u& position) {
+    for (auto& page : atlas.pages) {
+        if (const auto placed = page->packer.insert(rectSize)) {
+            position = *placed;
+            return page.get();
+        }
+    }
+
+    if (atlas.pages.size() < MAX_DYNAMIC_PAGES) {
+        auto page = std::make_unique<GlyphPage>();
+        if (!page->target.resize({DYNAMIC_PAGE_SIZE, DYNAMIC_PAGE_SIZE})) {
+            std::cerr << "Failed to create glyph page" << std::endl;
+            return nullptr;
+        }
+        page->target.clear(sf::Color::Transparent);
+        page->packer.reset({DYNAMIC_PAGE_SIZE, DYNAMIC_PAGE_SIZE});
+        page->number = static_cast<unsigned int>(atlas.pages.size() + 1);
+        atlas.pages.push_back(std::move(page));
+        if (const auto placed = atlas.pages.back()->packer.insert(rectSize)) {
+            position = *placed;
+            return atlas.pages.back().get();
+        }
+        return nullptr;
+    }
+
+    GlyphPage* victim = nullptr;
+    bool skippedPinned = false;
+    for (auto& page : atlas.pages) {
+        if (page->lastUsed == useCounter) {
+            continue;
+        }
+        if (isPinned(*page)) {
+            skippedPinned = true;
+        } else if (!victim || page->lastUsed < victim->lastUsed) {
+            victim = page.get();
+        }
+    }
+    if (!victim) {
+        evictionBlocked = evictionBlocked || skippedPinned;
+        return nullptr;
+    }
+
+    evictPage(atlas, *victim);
+    if (const auto placed = victim->packer.insert(rectSize)) {
+        position = *placed;
+        return victim;
+    }
+    return nullptr;
+}
+
+void FontGenerator::evictPage(Atlas& atlas, GlyphPage& page) {
+    for (const uint32_t charcode : page.glyphs) {
+        atlas.glyphMap.erase(charcode);
+    }
+    page.glyphs.clear();
+    page.packer.reset({DYNAMIC_PAGE_SIZE, DYNAMIC_PAGE_SIZE});
+    page.target.clear(sf::Color::Transparent);
+    ++layoutEpoch;
+}
+
+bool FontGenerator::isPinned(const GlyphPage& page) const {
+    return std::find(pinnedPages.begin(), pinnedPages.end(), &page.target.getTexture()) != pinnedPages.end();
+}
+
+void FontGenerator::pinPages(const std::vector<const sf::Texture*>& textures) {
+    std::lock_guard lock(pageMutex);
+    pinnedPages = textures;
+}
+
+void FontGenerator::unpinPages() {
+    std::lock_guard lock(pageMutex);
+    pinnedPages.clear();
+    if (evictionBlocked) {
+        evictionBlocked = false;
+        ++layoutEpoch;
+    }
 }
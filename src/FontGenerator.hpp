@@ -1,8 +1,16 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "AtlasPacker.hpp"
 
 class FontGenerator {
 public:
@@ -11,36 +19,119 @@ public:
         sf::Vector2f size;
         float advance;
         sf::Vector2f offset;
+        unsigned int page{0};
     };
 
+    using GlyphRanges = std::vector<std::pair<uint32_t, uint32_t>>;
+
     static FontGenerator& getInstance();
     
     bool generateBitmapFont(const std::string& ttfPath, unsigned int fontSize);
-    const sf::Texture& getTexture() const { return fontTexture; }
+    bool generateBitmapFont(const std::string& ttfPath, unsigned int fontSize, const GlyphRanges& ranges);
+    const sf::Texture& getTexture() const { return activeAtlas ? activeAtlas->texture : emptyTexture; }
+    const sf::Texture& getPageTexture(unsigned int page) const;
     const GlyphInfo* getGlyphInfo(uint32_t charcode) const;
-    float getLineHeight() const { return lineHeight; }
-    void refreshTexture() {
-        fontTexture = renderTex.getTexture();
-    }
+    void warmGlyphs(const sf::String& text);
+    void warmGlyphs(std::u32string_view text);
+    float getKerning(uint32_t first, uint32_t second);
+    std::optional<float> getAdvance(uint32_t charcode);
+    std::uint64_t getLayoutEpoch() const { return layoutEpoch; }
+    float getLineHeight() const { return activeAtlas ? activeAtlas->lineHeight : 0.0f; }
+    void setCacheDirectory(std::string directory) { cacheDirectory = std::move(directory); }
+
+    std::unique_lock<std::mutex> lockPages() { return std::unique_lock<std::mutex>(pageMutex); }
+    void pinPages(const std::vector<const sf::Texture*>& textures);
+    void unpinPages();
 
-    void renderDebugInfo(sf::RenderWindow& window, sf::Vector2f position = {10, 10}) const;
+    void renderDebugInfo(sf::RenderTarget& window, sf::Vector2f position = {10, 10}) const;
 
     std::vector<uint32_t> getAvailableCharacters() const {
         std::vector<uint32_t> chars;
-        for (const auto& pair : glyphMap) {
+        if (!activeAtlas) {
+            return chars;
+        }
+        for (const auto& pair : activeAtlas->glyphMap) {
             chars.push_back(pair.first);
         }
         return chars;
     }
 
+    static const GlyphRanges DEFAULT_RANGES;
+    static constexpr unsigned int DYNAMIC_PAGE_SIZE = 1024;
+    static constexpr std::size_t MAX_DYNAMIC_PAGES = 4;
+
 private:
-    FontGenerator() {
-        renderTex = sf::RenderTexture(sf::Vector2u{1, 1});
-        fontTexture = renderTex.getTexture();
-    }
+    struct GlyphPage {
+        sf::RenderTexture target;
+        AtlasPacker packer;
+        std::vector<uint32_t> glyphs;
+        std::uint64_t lastUsed{0};
+        unsigned int number{0};
+    };
+
+    struct Atlas {
+        sf::Texture texture;
+        std::unordered_map<uint32_t, GlyphInfo> glyphMap;
+        float lineHeight{0.0f};
+
+        std::string ttfPath;
+        unsigned int fontSize{0};
+        std::unique_ptr<sf::Font> font;
+        bool fontUnavailable{false};
+        std::size_t glyphsSinceFontReset{0};
+        std::vector<std::unique_ptr<GlyphPage>> pages;
+        std::unordered_set<uint32_t> missingGlyphs;
+        std::unordered_map<std::uint64_t, float> kerning;
+        std::unordered_map<uint32_t, float> advances;
+        bool kerningDirty{false};
+        std::string cachePath;
+        std::uint64_t kerningOffset{0};
+    };
+
+    struct SourceStamp {
+        std::uint64_t size{0};
+        std::int64_t modified{0};
+    };
+
+    enum class RasterResult {
+        Rasterized,
+        NotInFont,
+        NoSpace
+    };
+
+    struct RasterBatch {
+        std::vector<std::pair<uint32_t, sf::Glyph>> glyphs;
+        sf::Image page;
+        float lineHeight{0.0f};
+        bool loaded{false};
+    };
+
+    FontGenerator() = default;
+    ~FontGenerator();
+
+    static std::string makeKey(const std::string& ttfPath, unsigned int fontSize, const GlyphRanges& ranges);
+    static bool stampSource(const std::string& ttfPath, SourceStamp& stamp);
+    std::string cachePathFor(const std::string& key) const;
+    static bool rasterize(const std::string& ttfPath, unsigned int fontSize, const GlyphRanges& ranges, Atlas& atlas);
+    static void rasterizeBatch(const std::string& ttfPath, unsigned int fontSize, const std::vector<uint32_t>& codepoints,
+                               std::size_t first, std::size_t stride, RasterBatch& batch);
+    static bool loadCachedAtlas(const std::string& cachePath, const SourceStamp& stamp, unsigned int fontSize, Atlas& atlas);
+    static bool saveCachedAtlas(const std::string& cachePath, const SourceStamp& stamp, unsigned int fontSize, Atlas& atlas);
+    static bool saveKerning(const Atlas& atlas);
+
+    static bool openFont(Atlas& atlas);
+    RasterResult rasterizeGlyph(Atlas& atlas, uint32_t charcode, std::vector<GlyphPage*>& dirtyPages);
+    GlyphPage* allocateGlyph(Atlas& atlas, sf::Vector2u rectSize, sf::Vector2u& position);
+    void evictPage(Atlas& atlas, GlyphPage& page);
+    bool isPinned(const GlyphPage& page) const;
     
-    sf::RenderTexture renderTex;
-    sf::Texture fontTexture;
-    std::unordered_map<uint32_t, GlyphInfo> glyphMap;
-    float lineHeight{0.0f};
+    sf::Texture emptyTexture;
+    std::unordered_map<std::string, std::unique_ptr<Atlas>> atlases;
+    Atlas* activeAtlas{nullptr};
+    std::uint64_t useCounter{0};
+    std::atomic<std::uint64_t> layoutEpoch{0};
+    std::mutex pageMutex;
+    std::vector<const sf::Texture*> pinnedPages;
+    bool evictionBlocked{false};
+    std::string cacheDirectory{"assets/cache/fonts"};
 };
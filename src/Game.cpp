@@ -1,61 +1,190 @@
 #include "Game.hpp"
-#include "ScriptedScene.hpp"
 #include <SFML/Window/Event.hpp>
+#include <thread>
 
+#include "AssetPack.hpp"
 #include "FontGenerator.hpp"
+#include "Profiler.hpp"
 
-Game::Game()
+Game::Game(const bool threadedMode)
     : window(sf::VideoMode({1280u, 720u}), "GRILLING Visual Novel Engine")
-    , sceneManager(this, "assets/scripts")
-    , isRunning(true) {
+    , sceneManager("assets/scripts")
+    , isRunning(true)
+    , threaded(threadedMode) {
     window.setFramerateLimit(60);
+    AssetPack::getInstance().mount(AssetPack::DEFAULT_PATH);
     if (!sceneManager.initialize()) {
         isRunning = false;
     }
 }
 
 void Game::run() {
+    if (threaded) {
+        runThreaded();
+        return;
+    }
     sf::Clock clock;
+    bool idle = false;
     while (isRunning && window.isOpen()) {
+        bool hadEvents = false;
+        if (idle) {
+            VN_PROFILE_SCOPE("Game::idle");
+            if (const std::optional<sf::Event> event = window.waitEvent(sf::milliseconds(IDLE_TIMEOUT.count()))) {
+                handleEvent(*event);
+                hadEvents = true;
+            }
+        }
         sf::Time deltaTime = clock.restart();
-        processEvents();
+        hadEvents = processEvents() || hadEvents;
         update(deltaTime.asSeconds());
-        render();
+
+        const bool wasIdle = idle;
+        idle = !hadEvents && isIdle();
+        if (!wasIdle || !idle) {
+            render();
+        }
+    }
+}
+
+bool Game::isIdle() const {
+    const InputState input = pollInput();
+    return !input.advance && !input.skip && !sceneManager.isAnimating() && !Profiler::getInstance().isOverlayVisible();
+}
+
+void Game::runThreaded() {
+    std::thread simulation(&Game::simulate, this);
+    while (isRunning && window.isOpen()) {
+        processEvents();
+        {
+            std::lock_guard lock(frameMutex);
+            sharedInput = pollInput();
+        }
+        if (const RenderSnapshot* frame = acquireFrame()) {
+            {
+                VN_PROFILE_SCOPE("Game::render");
+                const auto pages = FontGenerator::getInstance().lockPages();
+                window.clear();
+                frame->render(window);
+            }
+            releaseFrame();
+            Profiler::getInstance().renderOverlay(window);
+            window.display();
+        }
+    }
+    isRunning = false;
+    frameChanged.notify_all();
+    simulation.join();
+}
+
+void Game::simulate() {
+    sf::Clock clock;
+    std::size_t back = 0;
+    while (isRunning) {
+        update(clock.restart().asSeconds());
+        RenderSnapshot& snapshot = snapshots[back];
+        snapshot.clear();
+        sceneManager.capture(snapshot);
+        publishFrame(back);
+        back = 1 - back;
+    }
+}
+
+void Game::publishFrame(const std::size_t index) {
+    {
+        std::unique_lock lock(frameMutex);
+        frameChanged.wait(lock, [this] { return !isRunning || (!framePending && !drawingFrame); });
+        FontGenerator::getInstance().pinPages(snapshots[index].getVertexTextures());
+        pendingSnapshot = index;
+        framePending = true;
+    }
+    frameChanged.notify_all();
+}
+
+const RenderSnapshot* Game::acquireFrame() {
+    std::unique_lock lock(frameMutex);
+    if (!frameChanged.wait_for(lock, FRAME_WAIT, [this] { return framePending || !isRunning; }) || !framePending) {
+        return nullptr;
+    }
+    framePending = false;
+    drawingFrame = true;
+    return &snapshots[pendingSnapshot];
+}
+
+void Game::releaseFrame() {
+    FontGenerator::getInstance().unpinPages();
+    {
+        std::lock_guard lock(frameMutex);
+        drawingFrame = false;
     }
+    frameChanged.notify_all();
 }
 
-void Game::processEvents() {
+bool Game::processEvents() {
+    bool hadEvents = false;
     while (const std::optional<sf::Event> event = window.pollEvent()) {
-        if (event->is<sf::Event::Closed>()) {
+        handleEvent(*event);
+        hadEvents = true;
+    }
+    windowFocused = window.hasFocus();
+    return hadEvents;
+}
+
+void Game::handleEvent(const sf::Event& event) {
+    if (event.is<sf::Event::Closed>()) {
+        window.close();
+        isRunning = false;
+    }
+
+    if (const auto* keyPressed = event.getIf<sf::Event::KeyPressed>()) {
+        if (keyPressed->code == sf::Keyboard::Key::Escape) {
             window.close();
             isRunning = false;
-        }
-        
-        if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
-            if (keyPressed->code == sf::Keyboard::Key::Escape) {
-                window.close();
-                isRunning = false;
-            }
+        } else if (keyPressed->code == sf::Keyboard::Key::F3) {
+            Profiler::getInstance().toggleOverlay();
+        } else if (keyPressed->code == sf::Keyboard::Key::F4) {
+            Profiler::getInstance().writeChromeTrace("profile.json");
+            Profiler::getInstance().writeCsv("profile.csv");
         }
     }
 }
 
 void Game::update(const float deltaTime) {
+    VN_PROFILE_SCOPE("Game::update");
+    sceneManager.setInput(currentInput());
     sceneManager.update(deltaTime);
-    
-    if (auto* scriptedScene = dynamic_cast<ScriptedScene*>(sceneManager.getCurrentScene())) {
-        if (scriptedScene->isSceneInitialized() && 
-            scriptedScene->isComplete() && 
-            !scriptedScene->isCommandInProgress()) {
-            if (!sceneManager.loadNextScene()) {
-                isRunning = false;
-            }
-        }
+
+    if (!sceneManager.advanceFinishedScene()) {
+        isRunning = false;
+    }
+}
+
+InputState Game::currentInput() {
+    if (!threaded) {
+        return pollInput();
+    }
+    std::lock_guard lock(frameMutex);
+    return sharedInput;
+}
+
+InputState Game::pollInput() const {
+    InputState input;
+    if (!windowFocused) {
+        return input;
     }
+    input.advance = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space) ||
+                    sf::Mouse::isButtonPressed(sf::Mouse::Button::Left);
+    input.skip = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl) ||
+                 sf::Keyboard::isKeyPressed(sf::Keyboard::Key::RControl) ||
+                 sf::Mouse::isButtonPressed(sf::Mouse::Button::Right);
+    return input;
 }
 
 void Game::render() {
-    window.clear();
-    sceneManager.render(window);
+    {
+        VN_PROFILE_SCOPE("Game::render");
+        window.clear();
+        sceneManager.render(window);
+    }
+    Profiler::getInstance().renderOverlay(window);
     window.display();
 }
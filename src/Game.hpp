@@ -1,18 +1,47 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "RenderSnapshot.hpp"
 #include "SceneManager.hpp"
 
 class Game {
 private:
     sf::RenderWindow window;
     SceneManager sceneManager;
-    bool isRunning;
+    std::atomic<bool> isRunning;
+    std::atomic<bool> windowFocused{true};
+
+    bool threaded{false};
+    std::mutex frameMutex;
+    std::condition_variable frameChanged;
+    std::array<RenderSnapshot, 2> snapshots;
+    std::size_t pendingSnapshot{0};
+    bool framePending{false};
+    bool drawingFrame{false};
+    InputState sharedInput;
+
+    static constexpr std::chrono::milliseconds FRAME_WAIT{50};
+    static constexpr std::chrono::milliseconds IDLE_TIMEOUT{250};
 
 public:
-    Game();
+    explicit Game(bool threadedMode = false);
     void run();
-    void processEvents();
+    bool processEvents();
     void update(float deltaTime);
     void render();
-    bool isWindowActive() const { return window.hasFocus(); }
+    InputState pollInput() const;
+
+private:
+    void runThreaded();
+    void handleEvent(const sf::Event& event);
+    bool isIdle() const;
+    void simulate();
+    void publishFrame(std::size_t index);
+    const RenderSnapshot* acquireFrame();
+    void releaseFrame();
+    InputState currentInput();
 };
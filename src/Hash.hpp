@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+inline std::uint64_t hashBytes(const char* data, const std::size_t size, std::uint64_t hash = 14695981039346656037ull) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline std::uint64_t hashString(const std::string& str) {
+    return hashBytes(str.data(), str.size());
+}
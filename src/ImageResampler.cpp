@@ -0,0 +1,117 @@
+#include "ImageResampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+ImageResampler::Filter ImageResampler::makeFilter(const std::uint32_t sourceSize, const std::uint32_t targetSize) {
+    const float scale = static_cast<float>(targetSize) / static_cast<float>(sourceSize);
+    const float support = std::max(1.0f, 1.0f / scale);
+
+    Filter filter;
+    filter.taps = static_cast<std::uint32_t>(std::ceil(support)) * 2 + 1;
+    filter.first.resize(targetSize);
+    filter.count.resize(targetSize);
+    filter.weights.assign(static_cast<std::size_t>(targetSize) * filter.taps, 0.0f);
+
+    for (std::uint32_t out = 0; out < targetSize; ++out) {
+        const float center = (static_cast<float>(out) + 0.5f) / scale - 0.5f;
+        const auto begin = static_cast<std::int64_t>(std::floor(center - support)) + 1;
+        const std::int64_t first = std::clamp<std::int64_t>(begin, 0, sourceSize - 1);
+        const std::int64_t last = std::clamp<std::int64_t>(begin + filter.taps - 1, 0, sourceSize - 1);
+
+        float* weights = filter.weights.data() + static_cast<std::size_t>(out) * filter.taps;
+        float total = 0.0f;
+        for (std::int64_t i = first; i <= last; ++i) {
+            const float weight = std::max(0.0f, 1.0f - std::abs(static_cast<float>(i) - center) / support);
+            weights[i - first] = weight;
+            total += weight;
+        }
+        if (total <= 0.0f) {
+            weights[0] = total = 1.0f;
+        }
+        for (std::int64_t i = 0; i <= last - first; ++i) {
+            weights[i] /= total;
+        }
+        filter.first[out] = static_cast<std::uint32_t>(first);
+        filter.count[out] = static_cast<std::uint32_t>(last - first + 1);
+    }
+    return filter;
+}
+
+std::vector<std::uint8_t> ImageResampler::resize(const std::uint8_t* pixels, const sf::Vector2u size, const sf::Vector2u targetSize) {
+    const std::size_t sourceStride = static_cast<std::size_t>(size.x) * 4;
+    const std::size_t targetStride = static_cast<std::size_t>(targetSize.x) * 4;
+    const Filter horizontal = makeFilter(size.x, targetSize.x);
+    const Filter vertical = makeFilter(size.y, targetSize.y);
+
+    std::vector<float> row(sourceStride);
+    std::vector<float> narrowed(static_cast<std::size_t>(size.y) * targetStride);
+    for (std::uint32_t y = 0; y < size.y; ++y) {
+        const std::uint8_t* src = pixels + y * sourceStride;
+        for (std::size_t x = 0; x < sourceStride; x += 4) {
+            const float alpha = src[x + 3] * (1.0f / 255.0f);
+            row[x + 0] = src[x + 0] * alpha;
+            row[x + 1] = src[x + 1] * alpha;
+            row[x + 2] = src[x + 2] * alpha;
+            row[x + 3] = src[x + 3];
+        }
+
+        float* dst = narrowed.data() + y * targetStride;
+        for (std::uint32_t x = 0; x < targetSize.x; ++x) {
+            const float* weights = horizontal.weights.data() + static_cast<std::size_t>(x) * horizontal.taps;
+            const float* taps = row.data() + static_cast<std::size_t>(horizontal.first[x]) * 4;
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (std::uint32_t k = 0; k < horizontal.count[x]; ++k) {
+                for (int c = 0; c < 4; ++c) {
+                    acc[c] += weights[k] * taps[k * 4 + c];
+                }
+            }
+            for (int c = 0; c < 4; ++c) {
+                dst[x * 4 + c] = acc[c];
+            }
+        }
+    }
+
+    std::vector<float> acc(targetStride);
+    std::vector<std::uint8_t> result(static_cast<std::size_t>(targetSize.y) * targetStride);
+    for (std::uint32_t y = 0; y < targetSize.y; ++y) {
+        std::fill(acc.begin(), acc.end(), 0.0f);
+        const float* weights = vertical.weights.data() + static_cast<std::size_t>(y) * vertical.taps;
+        for (std::uint32_t k = 0; k < vertical.count[y]; ++k) {
+            const float weight = weights[k];
+            const float* src = narrowed.data() + (vertical.first[y] + k) * targetStride;
+            for (std::size_t i = 0; i < targetStride; ++i) {
+                acc[i] += weight * src[i];
+            }
+        }
+
+        std::uint8_t* dst = result.data() + y * targetStride;
+        for (std::size_t x = 0; x < targetStride; x += 4) {
+            const float alpha = std::clamp(acc[x + 3], 0.0f, 255.0f);
+            const float unpremultiply = alpha > 0.0f ? 255.0f / alpha : 0.0f;
+            for (int c = 0; c < 3; ++c) {
+                dst[x + c] = static_cast<std::uint8_t>(std::clamp(acc[x + c] * unpremultiply, 0.0f, 255.0f) + 0.5f);
+            }
+            dst[x + 3] = static_cast<std::uint8_t>(alpha + 0.5f);
+        }
+    }
+    return result;
+}
+
+sf::Image ImageResampler::resize(const sf::Image& image, const sf::Vector2u targetSize) {
+    const std::vector<std::uint8_t> pixels = resize(image.getPixelsPtr(), image.getSize(), targetSize);
+    return sf::Image(targetSize, pixels.data());
+}
+
+sf::Vector2u ImageResampler::coverSize(const sf::Vector2u size, const sf::Vector2u target) {
+    const float scale = std::max(static_cast<float>(target.x) / static_cast<float>(size.x),
+                                 static_cast<float>(target.y) / static_cast<float>(size.y));
+    return scaledSize(size, scale);
+}
+
+sf::Vector2u ImageResampler::scaledSize(const sf::Vector2u size, const float scale) {
+    if (scale >= 1.0f) {
+        return size;
+    }
+    return {std::max(1u, static_cast<unsigned int>(std::lround(static_cast<float>(size.x) * scale))),
+            std::max(1u, static_cast<unsigned int>(std::lround(static_cast<float>(size.y) * scale)))};
+}
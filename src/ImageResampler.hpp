@@ -0,0 +1,23 @@
+#pragma once
+#include <SFML/Graphics/Image.hpp>
+#include <cstdint>
+#include <vector>
+
+class ImageResampler {
+public:
+    static std::vector<std::uint8_t> resize(const std::uint8_t* pixels, sf::Vector2u size, sf::Vector2u targetSize);
+    static sf::Image resize(const sf::Image& image, sf::Vector2u targetSize);
+
+    static sf::Vector2u coverSize(sf::Vector2u size, sf::Vector2u target);
+    static sf::Vector2u scaledSize(sf::Vector2u size, float scale);
+
+private:
+    struct Filter {
+        std::vector<std::uint32_t> first;
+        std::vector<std::uint32_t> count;
+        std::vector<float> weights;
+        std::uint32_t taps{0};
+    };
+
+    static Filter makeFilter(std::uint32_t sourceSize, std::uint32_t targetSize);
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+struct InputState {
+    bool advance{false};
+    bool skip{false};
+};
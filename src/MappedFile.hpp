@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] bool isOpen() const { return data != nullptr; }
+    [[nodiscard]] const char* getData() const { return data; }
+    [[nodiscard]] std::size_t getSize() const { return size; }
+
+private:
+    const char* data{nullptr};
+    std::size_t size{0};
+#ifdef _WIN32
+    void* fileHandle{nullptr};
+    void* mappingHandle{nullptr};
+#endif
+};
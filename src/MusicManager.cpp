@@ -1,93 +1,150 @@
 #include "MusicManager.hpp"
+#include "AssetPack.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-void MusicManager::loadTrack(const std::string& name, const std::string& path, bool loop) {
+namespace {
+    constexpr float HALF_PI = 1.57079632679f;
+}
+
+std::unique_ptr<sf::Music> MusicManager::openTrack(const std::string& path) {
     auto music = std::make_unique<sf::Music>();
-    if (!music->openFromFile(path)) {
+    if (!AssetPack::getInstance().openMusic(path, *music)) {
         std::cerr << "Failed to load music track: " << path << std::endl;
-        return;
+        return nullptr;
     }
+    return music;
+}
+
+std::size_t MusicManager::loadTrack(const std::string& name, const std::string& path, bool loop) {
+    return addTrack(name, path, loop, openTrack(path));
+}
+
+std::size_t MusicManager::addTrack(const std::string& name, const std::string& path, const bool loop, std::unique_ptr<sf::Music> music) {
     TrackInfo trackInfo;
     trackInfo.music = std::move(music);
+    trackInfo.name = name;
     trackInfo.path = path;
     trackInfo.loop = loop;
-    tracks[name] = std::move(trackInfo);
+    tracks.push_back(std::move(trackInfo));
+    return tracks.size() - 1;
 }
 
-void MusicManager::playTrack(const std::string& name, const float volume, float fadeInTime, float fadeOutTime) {
-    if (currentTrack.music && currentTrack.music->getStatus() == sf::SoundSource::Status::Playing) {
-        if (fadeOutTime > 0.f) {
-            currentTrack.targetVolume = 0.f;
-            currentTrack.fadeTime = fadeOutTime;
-            currentTrack.fadeTimer = 0.f;
-            currentTrack.fading = true;
+sf::Music* MusicManager::musicFor(const Voice& voice) const {
+    return voice.trackId < tracks.size() ? tracks[voice.trackId].music.get() : nullptr;
+}
+
+bool MusicManager::isPlaying(const Voice& voice) const {
+    const sf::Music* music = musicFor(voice);
+    return music && music->getStatus() == sf::SoundSource::Status::Playing;
+}
+
+void MusicManager::applyGain(Voice& voice, const float gain) {
+    voice.gain = std::clamp(gain, 0.f, 1.f);
+    if (sf::Music* music = musicFor(voice)) {
+        music->setVolume(voice.volume * voice.gain);
+    }
+}
+
+void MusicManager::releaseVoice(Voice& voice) {
+    if (sf::Music* music = musicFor(voice)) {
+        music->stop();
+    }
+    voice = Voice{};
+}
+
+void MusicManager::fadeVoice(Voice& voice, const float targetGain, const float fadeTime) {
+    if (fadeTime <= 0.f) {
+        voice.fading = false;
+        if (targetGain <= 0.f) {
+            releaseVoice(voice);
         } else {
-            currentTrack.music->stop();
+            applyGain(voice, targetGain);
         }
+        return;
+    }
+    voice.fadeFrom = voice.gain;
+    voice.fadeTo = targetGain;
+    voice.fadeTime = fadeTime;
+    voice.fadeTimer = 0.f;
+    voice.fading = true;
+}
+
+void MusicManager::playTrack(const std::size_t trackId, const float volume, float fadeInTime, float fadeOutTime, const bool loop) {
+    if (trackId >= tracks.size() || !tracks[trackId].music) {
+        return;
     }
 
-    if (const auto it = tracks.find(name); it != tracks.end()) {
-        currentTrack.music = std::make_unique<sf::Music>();
-        if (!currentTrack.music->openFromFile(it->second.path)) {
-            std::cerr << "Failed to open music from file: " << it->second.path << std::endl;
-            return;
-        }
+    auto voice = std::find_if(voices.begin(), voices.end(),
+                              [&](const Voice& v) { return v.trackId == trackId && isPlaying(v); });
+    if (voice == voices.end()) {
+        voice = std::find_if(voices.begin(), voices.end(), [&](const Voice& v) { return !isPlaying(v); });
+    }
+    if (voice == voices.end()) {
+        voice = std::min_element(voices.begin(), voices.end(),
+                                 [](const Voice& a, const Voice& b) { return a.volume * a.gain < b.volume * b.gain; });
+    }
 
-        currentTrack.music->setLooping(false);
-        
-        if (it->second.loop) {
-            currentTrack.music->setLooping(true);
-            currentTrack.music->setLoopPoints(sf::Music::TimeSpan{
-                sf::Time::Zero,
-                currentTrack.music->getDuration()
-            });
+    for (auto& other : voices) {
+        if (&other == &*voice) {
+            continue;
         }
-        
-        if (fadeInTime > 0.f) {
-            currentTrack.music->setVolume(0.f);
-            currentTrack.targetVolume = volume;
-            currentTrack.currentVolume = 0.f;
-            currentTrack.fadeTime = fadeInTime;
-            currentTrack.fadeTimer = 0.f;
-            currentTrack.fading = true;
-        } else {
-            currentTrack.music->setVolume(volume);
-            currentTrack.currentVolume = volume;
-            currentTrack.fading = false;
+        if (other.trackId == trackId) {
+            other = Voice{};
+        } else if (isPlaying(other)) {
+            fadeVoice(other, 0.f, fadeOutTime);
         }
-        currentTrack.music->play();
-        currentTrackName = name;
     }
+
+    if (voice->trackId != trackId || !isPlaying(*voice)) {
+        releaseVoice(*voice);
+        voice->trackId = trackId;
+        sf::Music& music = *tracks[trackId].music;
+        music.setLooping(tracks[trackId].loop || loop);
+        voice->volume = volume;
+        applyGain(*voice, 0.f);
+        music.play();
+    }
+    voice->volume = volume;
+    fadeVoice(*voice, 1.f, fadeInTime);
 }
 
 void MusicManager::stopMusic(float fadeOutTime) {
-    if (currentTrack.music && currentTrack.music->getStatus() == sf::SoundSource::Status::Playing) {
-        if (fadeOutTime > 0.f) {
-            currentTrack.targetVolume = 0.f;
-            currentTrack.fadeTime = fadeOutTime;
-            currentTrack.fadeTimer = 0.f;
-            currentTrack.fading = true;
-        } else {
-            currentTrack.music->stop();
+    for (auto& voice : voices) {
+        if (isPlaying(voice)) {
+            fadeVoice(voice, 0.f, fadeOutTime);
+        } else if (voice.trackId != NO_TRACK) {
+            releaseVoice(voice);
         }
     }
 }
 
+bool MusicManager::isFading() const {
+    return std::any_of(voices.begin(), voices.end(), [](const Voice& voice) { return voice.fading; });
+}
+
 void MusicManager::update(float deltaTime) {
-    if (currentTrack.music && currentTrack.fading) {
-        currentTrack.fadeTimer += deltaTime;
-
-        if (const float progress = currentTrack.fadeTimer / currentTrack.fadeTime; progress >= 1.f) {
-            if (currentTrack.targetVolume == 0.f) {
-                currentTrack.music->stop();
-            } else {
-                currentTrack.music->setVolume(currentTrack.targetVolume);
-            }
-            currentTrack.fading = false;
+    VN_PROFILE_SCOPE("MusicManager::update");
+    for (auto& voice : voices) {
+        if (!voice.fading) {
+            continue;
+        }
+
+        voice.fadeTimer += deltaTime;
+        const float progress = std::min(voice.fadeTimer / voice.fadeTime, 1.f);
+        if (voice.fadeTo > voice.fadeFrom) {
+            applyGain(voice, voice.fadeFrom + (voice.fadeTo - voice.fadeFrom) * std::sin(progress * HALF_PI));
         } else {
-            const float newVolume = currentTrack.currentVolume +
-                                    (currentTrack.targetVolume - currentTrack.currentVolume) * progress;
-            currentTrack.music->setVolume(newVolume);
+            applyGain(voice, voice.fadeTo + (voice.fadeFrom - voice.fadeTo) * std::cos(progress * HALF_PI));
+        }
+
+        if (progress >= 1.f) {
+            voice.fading = false;
+            if (voice.fadeTo <= 0.f) {
+                releaseVoice(voice);
+            }
         }
     }
-} 
\ No newline at end of file
+}
@@ -1,22 +1,33 @@
 #pragma once
 #include <SFML/Audio.hpp>
+#include <array>
 #include <memory>
 #include <string>
-#include <map>
+#include <vector>
 #include <filesystem>
 
 class MusicManager {
 public:
-    void loadTrack(const std::string& name, const std::string& path, bool loop = false);
-    void playTrack(const std::string& name, float volume = 100.f, float fadeInTime = 0.f, float fadeOutTime = 0.f);
+    static constexpr std::size_t VOICE_COUNT = 2;
+
+    static std::unique_ptr<sf::Music> openTrack(const std::string& path);
+
+    std::size_t loadTrack(const std::string& name, const std::string& path, bool loop = false);
+    std::size_t addTrack(const std::string& name, const std::string& path, bool loop, std::unique_ptr<sf::Music> music);
+    void playTrack(std::size_t trackId, float volume = 100.f, float fadeInTime = 0.f, float fadeOutTime = 0.f, bool loop = false);
+    bool isFading() const;
     void stopMusic(float fadeOutTime = 0.f);
     void update(float deltaTime);
 
 private:
-    struct MusicState {
-        std::unique_ptr<sf::Music> music;
-        float targetVolume{0.f};
-        float currentVolume{0.f};
+    static constexpr std::size_t NO_TRACK = static_cast<std::size_t>(-1);
+
+    struct Voice {
+        std::size_t trackId{NO_TRACK};
+        float volume{100.f};
+        float gain{0.f};
+        float fadeFrom{0.f};
+        float fadeTo{0.f};
         float fadeTime{0.f};
         float fadeTimer{0.f};
         bool fading{false};
@@ -24,11 +35,17 @@ private:
 
     struct TrackInfo {
         std::unique_ptr<sf::Music> music;
+        std::string name;
         std::string path;
         bool loop{false};
     };
 
-    std::map<std::string, TrackInfo> tracks;
-    MusicState currentTrack;
-    std::string currentTrackName;
-}; 
\ No newline at end of file
+    sf::Music* musicFor(const Voice& voice) const;
+    bool isPlaying(const Voice& voice) const;
+    void fadeVoice(Voice& voice, float targetGain, float fadeTime);
+    void applyGain(Voice& voice, float gain);
+    void releaseVoice(Voice& voice);
+
+    std::vector<TrackInfo> tracks;
+    std::array<Voice, VOICE_COUNT> voices;
+};
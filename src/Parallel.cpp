@@ -0,0 +1,27 @@
+#include "Parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+void parallelFor(const std::size_t count, const unsigned int jobs, const std::function<void(std::size_t)>& task) {
+    std::atomic<std::size_t> next{0};
+    const auto run = [&] {
+        for (std::size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+    const std::size_t threadCount = std::min<std::size_t>(std::max(1u, jobs), count);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threadCount; ++t) {
+        workers.emplace_back(run);
+    }
+    run();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int defaultJobCount() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+void parallelFor(std::size_t count, unsigned int jobs, const std::function<void(std::size_t)>& task);
+
+unsigned int defaultJobCount();
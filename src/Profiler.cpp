@@ -0,0 +1,160 @@
+#include "Profiler.hpp"
+#include "AssetPack.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+Profiler& Profiler::getInstance() {
+    static Profiler instance;
+    return instance;
+}
+
+std::uint32_t Profiler::currentThreadId() {
+    static std::atomic<std::uint32_t> nextId{0};
+    thread_local const std::uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+std::int64_t Profiler::toNanoseconds(const Clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch).count();
+}
+
+void Profiler::record(const char* name, const Clock::time_point start, const Clock::time_point end) {
+    const std::uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index % CAPACITY];
+
+    slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(toNanoseconds(start), std::memory_order_relaxed);
+    slot.duration.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), std::memory_order_relaxed);
+    slot.thread.store(currentThreadId(), std::memory_order_relaxed);
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+std::vector<Profiler::Sample> Profiler::snapshot() const {
+    const std::uint64_t end = writeIndex.load(std::memory_order_acquire);
+    const std::uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+
+    std::vector<Sample> samples;
+    samples.reserve(static_cast<std::size_t>(end - begin));
+    for (std::uint64_t index = begin; index < end; ++index) {
+        const Slot& slot = slots[index % CAPACITY];
+        const std::uint64_t expected = index * 2 + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            continue;
+        }
+
+        Sample sample;
+        sample.name = slot.name.load(std::memory_order_relaxed);
+        sample.start = slot.start.load(std::memory_order_relaxed);
+        sample.duration = slot.duration.load(std::memory_order_relaxed);
+        sample.thread = slot.thread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == expected && sample.name) {
+            samples.push_back(sample);
+        }
+    }
+    return samples;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to write profile trace: " << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& sample : snapshot()) {
+        if (!first) {
+            file << ",\n";
+        }
+        first = false;
+        file << "{\"name\":\"" << sample.name << "\",\"cat\":\"vn\",\"ph\":\"X\",\"pid\":1,\"tid\":" << sample.thread
+             << ",\"ts\":" << static_cast<double>(sample.start) / 1000.0
+             << ",\"dur\":" << static_cast<double>(sample.duration) / 1000.0 << "}";
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+bool Profiler::writeCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Failed to write profile CSV: " << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3) << "name,thread,start_us,duration_us\n";
+    for (const auto& sample : snapshot()) {
+        file << sample.name << ',' << sample.thread << ','
+             << static_cast<double>(sample.start) / 1000.0 << ','
+             << static_cast<double>(sample.duration) / 1000.0 << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+void Profiler::renderOverlay(sf::RenderTarget& target) {
+    if (!overlayVisible) {
+        return;
+    }
+
+    if (!overlayFont && !overlayFontFailed) {
+        overlayFont = std::make_unique<sf::Font>();
+        if (!AssetPack::getInstance().openFont(overlayFontPath, *overlayFont)) {
+            std::cerr << "Failed to load profiler overlay font: " << overlayFontPath << std::endl;
+            overlayFont.reset();
+            overlayFontFailed = true;
+        }
+    }
+    if (!overlayFont) {
+        return;
+    }
+
+    struct ScopeStats {
+        std::size_t calls{0};
+        std::int64_t total{0};
+        std::int64_t longest{0};
+    };
+
+    const std::vector<Sample> samples = snapshot();
+    const std::int64_t windowEnd = toNanoseconds(Clock::now());
+    constexpr std::int64_t WINDOW = 1000000000;
+
+    std::map<std::string, ScopeStats> stats;
+    for (const auto& sample : samples) {
+        if (sample.start + sample.duration < windowEnd - WINDOW) {
+            continue;
+        }
+        ScopeStats& scope = stats[sample.name];
+        ++scope.calls;
+        scope.total += sample.duration;
+        scope.longest = std::max(scope.longest, sample.duration);
+    }
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3) << "scope                     avg ms    max ms  calls/s\n";
+    for (const auto& [name, scope] : stats) {
+        text << std::left << std::setw(24) << name << std::right
+             << std::setw(9) << static_cast<double>(scope.total) / static_cast<double>(scope.calls) / 1e6
+             << std::setw(10) << static_cast<double>(scope.longest) / 1e6
+             << std::setw(9) << scope.calls << "\n";
+    }
+
+    sf::Text label(*overlayFont, text.str(), 14);
+    label.setFillColor(sf::Color::White);
+    label.setPosition({16.0f, 16.0f});
+
+    const sf::FloatRect bounds = label.getLocalBounds();
+    sf::RectangleShape panel({bounds.size.x + 24.0f, bounds.size.y + 24.0f});
+    panel.setPosition({4.0f, 4.0f});
+    panel.setFillColor(sf::Color(0, 0, 0, 180));
+
+    target.draw(panel);
+    target.draw(label);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef VN_ENABLE_PROFILER
+#define VN_ENABLE_PROFILER 1
+#endif
+
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sample {
+        const char* name{nullptr};
+        std::int64_t start{0};
+        std::int64_t duration{0};
+        std::uint32_t thread{0};
+    };
+
+    static constexpr std::size_t CAPACITY = 1 << 14;
+
+    static Profiler& getInstance();
+
+    void record(const char* name, Clock::time_point start, Clock::time_point end);
+    std::vector<Sample> snapshot() const;
+    bool writeChromeTrace(const std::string& path) const;
+    bool writeCsv(const std::string& path) const;
+
+    void toggleOverlay() { overlayVisible = !overlayVisible; }
+    bool isOverlayVisible() const { return overlayVisible; }
+    void setOverlayFont(std::string path) { overlayFontPath = std::move(path); overlayFont.reset(); }
+    void renderOverlay(sf::RenderTarget& target);
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<std::int64_t> start{0};
+        std::atomic<std::int64_t> duration{0};
+        std::atomic<std::uint32_t> thread{0};
+    };
+
+    Profiler() : epoch(Clock::now()) {}
+
+    static std::uint32_t currentThreadId();
+    std::int64_t toNanoseconds(Clock::time_point time) const;
+
+    Clock::time_point epoch;
+    std::array<Slot, CAPACITY> slots;
+    std::atomic<std::uint64_t> writeIndex{0};
+
+    std::atomic<bool> overlayVisible{false};
+    std::string overlayFontPath{"assets/resources/fonts/arial.ttf"};
+    std::unique_ptr<sf::Font> overlayFont;
+    bool overlayFontFailed{false};
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* scopeName) : name(scopeName), start(Profiler::Clock::now()) {}
+    ~ProfileScope() { Profiler::getInstance().record(name, start, Profiler::Clock::now()); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    Profiler::Clock::time_point start;
+};
+
+#define VN_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VN_PROFILE_CONCAT(a, b) VN_PROFILE_CONCAT_IMPL(a, b)
+
+#if VN_ENABLE_PROFILER
+#define VN_PROFILE_SCOPE(name) ProfileScope VN_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define VN_PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,46 @@
+#include "RenderSnapshot.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+
+void RenderSnapshot::clear() {
+    items.clear();
+    vertices.clear();
+    vertexTextures.clear();
+}
+
+void RenderSnapshot::draw(const sf::Sprite& sprite, TextureHandle texture) {
+    items.push_back({sprite, std::move(texture)});
+}
+
+void RenderSnapshot::draw(const sf::RectangleShape& shape) {
+    items.push_back({shape, nullptr});
+}
+
+void RenderSnapshot::draw(const sf::Vertex* source, const std::size_t count, const sf::PrimitiveType type, const sf::RenderStates& states) {
+    if (count == 0) {
+        return;
+    }
+    VertexRange range;
+    range.first = vertices.size();
+    range.count = count;
+    range.type = type;
+    range.states = states;
+    vertices.insert(vertices.end(), source, source + count);
+    items.push_back({range, nullptr});
+    if (states.texture && std::find(vertexTextures.begin(), vertexTextures.end(), states.texture) == vertexTextures.end()) {
+        vertexTextures.push_back(states.texture);
+    }
+}
+
+void RenderSnapshot::render(sf::RenderTarget& target) const {
+    VN_PROFILE_SCOPE("RenderSnapshot::render");
+    for (const auto& item : items) {
+        if (const auto* sprite = std::get_if<sf::Sprite>(&item.drawable)) {
+            target.draw(*sprite);
+        } else if (const auto* shape = std::get_if<sf::RectangleShape>(&item.drawable)) {
+            target.draw(*shape);
+        } else if (const auto* range = std::get_if<VertexRange>(&item.drawable)) {
+            target.draw(vertices.data() + range->first, range->count, range->type, range->states);
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <memory>
+#include <variant>
+#include <vector>
+
+class RenderSnapshot {
+public:
+    using TextureHandle = std::shared_ptr<const sf::Texture>;
+
+    void clear();
+    void draw(const sf::Sprite& sprite, TextureHandle texture);
+    void draw(const sf::RectangleShape& shape);
+    void draw(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, const sf::RenderStates& states);
+    void render(sf::RenderTarget& target) const;
+    const std::vector<const sf::Texture*>& getVertexTextures() const { return vertexTextures; }
+
+private:
+    struct VertexRange {
+        std::size_t first{0};
+        std::size_t count{0};
+        sf::PrimitiveType type{sf::PrimitiveType::Triangles};
+        sf::RenderStates states;
+    };
+
+    struct Item {
+        std::variant<sf::Sprite, sf::RectangleShape, VertexRange> drawable;
+        TextureHandle texture;
+    };
+
+    std::vector<Item> items;
+    std::vector<sf::Vertex> vertices;
+    std::vector<const sf::Texture*> vertexTextures;
+};
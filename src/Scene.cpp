@@ -1,17 +1,22 @@
 #include "Scene.hpp"
+#include "FontGenerator.hpp"
+#include "Profiler.hpp"
+#include <iostream>
 
 Scene::Scene()
-: background(defaultTexture)
+: defaultTexture(std::make_shared<sf::Texture>())
+, backgroundTexture(defaultTexture)
+, background(*defaultTexture)
 {
     const sf::Image img({1280u, 720u}, sf::Color(50, 50, 50));
-    defaultTexture.loadFromImage(img);
+    defaultTexture->loadFromImage(img);
     
-    background.setTexture(defaultTexture, true);
+    background.setTexture(*defaultTexture, true);
 
     constexpr float targetWidth = 1280.0f;
     constexpr float targetHeight = 720.0f;
-    const float textureWidth = static_cast<float>(defaultTexture.getSize().x);
-    const float textureHeight = static_cast<float>(defaultTexture.getSize().y);
+    const float textureWidth = static_cast<float>(defaultTexture->getSize().x);
+    const float textureHeight = static_cast<float>(defaultTexture->getSize().y);
     
     float scaleX = targetWidth / textureWidth;
     float scaleY = targetHeight / textureHeight;
@@ -25,23 +30,92 @@ Scene::Scene()
 }
 
 void Scene::load() {
+    loadFont();
     for (auto& character : characters) {
         character.setExpression("default");
     }
 }
 
+void Scene::loadFont() {
+    if (!FontGenerator::getInstance().generateBitmapFont("assets/resources/fonts/NotoSans.ttf", 24)) {
+        std::cerr << "Failed to generate bitmap font" << std::endl;
+    }
+}
+
 void Scene::update(const float deltaTime) {
     dialog.update(deltaTime);
 }
 
-void Scene::render(sf::RenderWindow& window) {
-    window.draw(background);
-    for (auto& character : characters) {
-        character.render(window);
+void Scene::render(sf::RenderTarget& window) {
+    if (!VN_CACHE_SCENE_LAYERS || !renderCachedLayers(window)) {
+        drawLayers(window);
     }
     dialog.render(window);
 }
 
+void Scene::drawLayers(sf::RenderTarget& target) const {
+    target.draw(background);
+    for (const auto& character : characters) {
+        character.render(target);
+    }
+}
+
+bool Scene::renderCachedLayers(sf::RenderTarget& window) {
+    if (layerCacheFailed) {
+        return false;
+    }
+    const bool created = !layerCache;
+    if (created) {
+        auto cache = std::make_unique<sf::RenderTexture>();
+        if (!cache->resize({1280u, 720u})) {
+            std::cerr << "Failed to create scene layer cache, drawing layers directly" << std::endl;
+            layerCacheFailed = true;
+            return false;
+        }
+        layerCache = std::move(cache);
+        layerSprite.emplace(layerCache->getTexture());
+    }
+
+    if (const std::uint64_t version = getLayerVersion(); created || version != layerCacheVersion) {
+        VN_PROFILE_SCOPE("Scene::composeLayers");
+        layerCache->clear();
+        drawLayers(*layerCache);
+        layerCache->display();
+        layerCacheVersion = version;
+    }
+    window.draw(*layerSprite);
+    return true;
+}
+
+std::uint64_t Scene::getLayerVersion() const {
+    std::uint64_t version = layerVersion;
+    for (const auto& character : characters) {
+        version += character.getVersion();
+    }
+    return version;
+}
+
+void Scene::capture(RenderSnapshot& snapshot) {
+    snapshot.draw(background, backgroundTexture);
+    for (const auto& character : characters) {
+        character.capture(snapshot);
+    }
+    dialog.capture(snapshot);
+}
+
+std::size_t Scene::estimateMemoryUsage(TextureCache::CountedTextures& countedTextures) const {
+    std::size_t bytes = sizeof(*this) + TextureCache::countTexture(defaultTexture.get(), countedTextures);
+    bytes += TextureCache::countTexture(backgroundTexture.get(), countedTextures);
+    if (layerCache) {
+        bytes += static_cast<std::size_t>(layerCache->getSize().x) * layerCache->getSize().y * 4;
+    }
+    for (const auto& character : characters) {
+        bytes += character.estimateMemoryUsage(countedTextures);
+    }
+    return bytes;
+}
+
 void Scene::addCharacter(Character&& character) {
     characters.push_back(std::move(character));
+    ++layerVersion;
 }
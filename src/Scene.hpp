@@ -1,34 +1,63 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 #include "Character.hpp"
 #include "Dialog.hpp"
+#include "Input.hpp"
+#include "RenderSnapshot.hpp"
+
+#ifndef VN_CACHE_SCENE_LAYERS
+#define VN_CACHE_SCENE_LAYERS 1
+#endif
 
 class Scene {
 protected:
-    sf::Texture defaultTexture;
+    std::shared_ptr<sf::Texture> defaultTexture;
+    TextureCache::Handle backgroundTexture;
     sf::Sprite background;
     std::vector<Character> characters;
     Dialog dialog;
     std::vector<std::string> dialogLines;
+    InputState input;
+
+    std::unique_ptr<sf::RenderTexture> layerCache;
+    std::optional<sf::Sprite> layerSprite;
+    std::uint64_t layerVersion{0};
+    std::uint64_t layerCacheVersion{0};
+    bool layerCacheFailed{false};
+
+    void drawLayers(sf::RenderTarget& target) const;
+    bool renderCachedLayers(sf::RenderTarget& window);
+    std::uint64_t getLayerVersion() const;
     
 public:
     Scene();
     virtual ~Scene() = default;
     virtual void load();
+    virtual void loadFont();
     virtual void update(float deltaTime);
-    virtual void render(sf::RenderWindow& window);
+    virtual void render(sf::RenderTarget& window);
+    virtual void capture(RenderSnapshot& snapshot);
+    virtual std::size_t estimateMemoryUsage(TextureCache::CountedTextures& countedTextures) const;
+    virtual bool shouldStayResident() const { return false; }
+    virtual bool isAnimating() const { return !dialog.isAnimationComplete(); }
     void addCharacter(Character&& character);
+    void setInput(const InputState& state) { input = state; }
     
-    void setBackground(const sf::Texture& texture) {
-        background.setTexture(texture);
+    void setBackground(TextureCache::Handle texture) {
+        backgroundTexture = std::move(texture);
+        background.setTexture(*backgroundTexture, true);
+        ++layerVersion;
 
         constexpr float targetWidth = 1280.0f;
         constexpr float targetHeight = 720.0f;
 
-        const float textureWidth = static_cast<float>(texture.getSize().x);
-        const float textureHeight = static_cast<float>(texture.getSize().y);
+        const float textureWidth = static_cast<float>(backgroundTexture->getSize().x);
+        const float textureHeight = static_cast<float>(backgroundTexture->getSize().y);
 
         float scaleX = targetWidth / textureWidth;
         float scaleY = targetHeight / textureHeight;
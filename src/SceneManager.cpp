@@ -1,7 +1,11 @@
 #include "SceneManager.hpp"
+#include "AssetPack.hpp"
 #include "ScriptedScene.hpp"
+#include "CompiledScript.hpp"
+#include "Profiler.hpp"
 #include <filesystem>
 #include <algorithm>
+#include <chrono>
 #include <utility>
 
 SceneManager::SceneManager(std::string  scriptDir)
@@ -17,7 +21,7 @@ SceneManager::SceneManager(std::string  scriptDir)
 }     
 
 bool SceneManager::initialize() {
-    if (!std::filesystem::exists(scriptsDirectory)) {
+    if (!std::filesystem::exists(scriptsDirectory) && AssetPack::getInstance().listFiles(scriptsDirectory).empty()) {
         return false;
     }
 
@@ -26,33 +30,16 @@ bool SceneManager::initialize() {
         return false;
     }
     
-    auto scene = std::make_unique<ScriptedScene>(currentScriptPath, game);
+    auto scene = std::make_unique<ScriptedScene>(currentScriptPath);
     addScene(currentScriptPath, std::move(scene));
     switchScene(currentScriptPath);
+    startPrefetch();
     return true;
 }
 
 std::string SceneManager::findFirstScript() const {
-    try {
-        std::vector<std::string> scriptFiles;
-        
-        for (const auto& entry : std::filesystem::directory_iterator(scriptsDirectory)) {
-            if (entry.path().extension() == ".yaml") {
-                scriptFiles.push_back(entry.path().string());
-            }
-        }
-        
-        if (scriptFiles.empty()) {
-            return "";
-        }
-        
-        std::sort(scriptFiles.begin(), scriptFiles.end());
-        return scriptFiles[0];
-    }
-    catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "Filesystem error: " << e.what() << std::endl;
-        return "";
-    }
+    const std::vector<std::string> scripts = ScriptParser::findScripts(scriptsDirectory);
+    return scripts.empty() ? "" : scripts.front();
 }
 
 bool SceneManager::loadNextScene() {
@@ -70,18 +57,127 @@ bool SceneManager::loadNextScene() {
     
     scriptedScene->stopMusic();
     
-    std::string fullPath = scriptsDirectory;
-    fullPath += "/" + nextScenePath;
-    
-    auto scene = std::make_unique<ScriptedScene>(fullPath, game);
+    const std::string fullPath = resolveScriptPath(nextScenePath);
+
+    if (!scenes.count(fullPath)) {
+        std::unique_ptr<Scene> scene;
+        if (prefetchPath == fullPath) {
+            pollPrefetch(true);
+            scene = std::move(prefetchedScene);
+        }
+        if (!scene) {
+            scene = std::make_unique<ScriptedScene>(fullPath);
+        }
+        addScene(fullPath, std::move(scene));
+    }
+    prefetchPath.clear();
+
     currentScriptPath = fullPath;
-    addScene(fullPath, std::move(scene));
     switchScene(fullPath);
+    evictScenes();
+    startPrefetch();
     return true;
 }
 
+bool SceneManager::advanceFinishedScene() {
+    const auto* scriptedScene = dynamic_cast<const ScriptedScene*>(currentScene);
+    if (!scriptedScene ||
+        !scriptedScene->isSceneInitialized() ||
+        !scriptedScene->isComplete() ||
+        scriptedScene->isCommandInProgress()) {
+        return true;
+    }
+    return loadNextScene();
+}
+
+void SceneManager::setResident(const std::string& name, const bool resident) {
+    if (resident) {
+        residentScenes.insert(name);
+    } else {
+        residentScenes.erase(name);
+    }
+}
+
+void SceneManager::touchScene(const std::string& name) {
+    recentScenes.remove(name);
+    recentScenes.push_front(name);
+}
+
+std::size_t SceneManager::estimateMemoryUsage() const {
+    TextureCache::CountedTextures countedTextures;
+    std::size_t totalUsage = 0;
+    for (const auto& [name, scene] : scenes) {
+        totalUsage += scene->estimateMemoryUsage(countedTextures);
+    }
+    return totalUsage;
+}
+
+void SceneManager::evictScenes() {
+    std::size_t totalUsage = estimateMemoryUsage();
+
+    for (auto it = recentScenes.rbegin(); it != recentScenes.rend() && totalUsage > memoryBudget;) {
+        const auto scene = scenes.find(*it);
+        if (scene == scenes.end()) {
+            it = std::make_reverse_iterator(recentScenes.erase(std::next(it).base()));
+            continue;
+        }
+        if (scene->second.get() == currentScene || residentScenes.count(*it) || scene->second->shouldStayResident()) {
+            ++it;
+            continue;
+        }
+
+        scenes.erase(scene);
+        totalUsage = estimateMemoryUsage();
+        it = std::make_reverse_iterator(recentScenes.erase(std::next(it).base()));
+    }
+}
+
+std::string SceneManager::resolveScriptPath(const std::string& scriptName) const {
+    std::string fullPath = scriptsDirectory;
+    fullPath += "/" + scriptName;
+    return fullPath;
+}
+
+void SceneManager::startPrefetch() {
+    if (prefetch.valid()) {
+        prefetch.wait();
+    }
+    prefetch = {};
+    prefetchedScene.reset();
+    prefetchPath.clear();
+
+    const auto* scriptedScene = dynamic_cast<const ScriptedScene*>(currentScene);
+    if (!scriptedScene || scriptedScene->getScriptData().nextScenePath == "exit") {
+        return;
+    }
+
+    const std::string nextPath = resolveScriptPath(scriptedScene->getScriptData().nextScenePath);
+    if (scenes.count(nextPath)) {
+        return;
+    }
+
+    prefetchPath = nextPath;
+    prefetch = std::async(std::launch::async, &ScriptedScene::prepare, prefetchPath);
+}
+
+void SceneManager::pollPrefetch(const bool wait) {
+    if (!prefetch.valid()) {
+        return;
+    }
+    if (!wait && prefetch.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+
+    try {
+        prefetchedScene = std::make_unique<ScriptedScene>(prefetch.get());
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to prefetch scene " << prefetchPath << ": " << e.what() << std::endl;
+    }
+}
+
 void SceneManager::addScene(const std::string& name, std::unique_ptr<Scene> scene) {
     scenes[name] = std::move(scene);
+    touchScene(name);
     if (!currentScene) {
         currentScene = scenes[name].get();
     }
@@ -90,18 +186,29 @@ void SceneManager::addScene(const std::string& name, std::unique_ptr<Scene> scen
 void SceneManager::switchScene(const std::string& name) {
     if (const auto it = scenes.find(name); it != scenes.end()) {
         currentScene = it->second.get();
+        touchScene(name);
         currentScene->load();
     }
 }
 
-void SceneManager::update(const float deltaTime) const {
+void SceneManager::update(const float deltaTime) {
+    VN_PROFILE_SCOPE("SceneManager::update");
     if (currentScene) {
+        currentScene->setInput(input);
         currentScene->update(deltaTime);
     }
+    pollPrefetch(false);
 }
 
-void SceneManager::render(sf::RenderWindow& window) const {
+void SceneManager::render(sf::RenderTarget& window) const {
     if (currentScene) {
         currentScene->render(window);
     }
 }
+
+void SceneManager::capture(RenderSnapshot& snapshot) const {
+    VN_PROFILE_SCOPE("SceneManager::capture");
+    if (currentScene) {
+        currentScene->capture(snapshot);
+    }
+}
@@ -1,38 +1,64 @@
 #pragma once
 #include <memory>
 #include <map>
+#include <list>
+#include <set>
 #include <string>
 #include <filesystem>
 #include <utility>
+#include <future>
 #include "Scene.hpp"
+#include "ScriptedScene.hpp"
+#include "Input.hpp"
 
-class Game;
+#ifndef VN_SCENE_MEMORY_BUDGET_MB
+#define VN_SCENE_MEMORY_BUDGET_MB 256
+#endif
 
 class SceneManager {
 private:
-    Game* game{nullptr};
     std::map<std::string, std::unique_ptr<Scene>> scenes;
     Scene* currentScene{nullptr};
     std::string scriptsDirectory;
     std::string currentScriptPath;
     bool shouldQuit{false};
+    InputState input;
 
-public:
-    explicit SceneManager(Game* gameInstance, std::string  scriptDir = "assets/scripts")
-        : game(gameInstance), scriptsDirectory(std::move(scriptDir)) {}
+    std::string prefetchPath;
+    std::future<PreparedScene> prefetch;
+    std::unique_ptr<Scene> prefetchedScene;
+
+    std::size_t memoryBudget{static_cast<std::size_t>(VN_SCENE_MEMORY_BUDGET_MB) * 1024 * 1024};
+    std::list<std::string> recentScenes;
+    std::set<std::string> residentScenes;
 
-    explicit SceneManager(std::string scriptDir);
+public:
+    explicit SceneManager(std::string scriptDir = "assets/scripts");
 
     bool initialize();
     bool loadNextScene();
+    bool advanceFinishedScene();
     [[nodiscard]] bool shouldExit() const { return shouldQuit; }
     void addScene(const std::string& name, std::unique_ptr<Scene> scene);
     void switchScene(const std::string& name);
-    void update(float deltaTime) const;
-    void render(sf::RenderWindow& window) const;
+    void update(float deltaTime);
+    void render(sf::RenderTarget& window) const;
+    void capture(RenderSnapshot& snapshot) const;
+    [[nodiscard]] bool isAnimating() const { return currentScene && currentScene->isAnimating(); }
+    void setInput(const InputState& state) { input = state; }
+    void setMemoryBudget(std::size_t bytes) { memoryBudget = bytes; }
+    [[nodiscard]] std::size_t getMemoryBudget() const { return memoryBudget; }
+    void setResident(const std::string& name, bool resident);
+    [[nodiscard]] std::size_t getLoadedSceneCount() const { return scenes.size(); }
     Scene* getCurrentScene() { return currentScene; }
     [[nodiscard]] const Scene* getCurrentScene() const { return currentScene; }
 
 private:
     [[nodiscard]] std::string findFirstScript() const;
+    [[nodiscard]] std::string resolveScriptPath(const std::string& scriptName) const;
+    void startPrefetch();
+    void pollPrefetch(bool wait);
+    void touchScene(const std::string& name);
+    void evictScenes();
+    [[nodiscard]] std::size_t estimateMemoryUsage() const;
 };
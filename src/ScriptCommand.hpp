@@ -0,0 +1,35 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+#include <string>
+
+struct ScriptCommand {
+    enum Type {
+        DIALOG,
+        MOVE,
+        MUSIC,
+        SFX
+    } type;
+
+    static constexpr int NONE = -1;
+
+    std::string character;
+    std::string text;
+    std::string expression;
+    sf::Vector2f position;
+    float duration{0.0f};
+    bool smooth{true};
+    
+    std::string musicName;
+    float volume{100.0f};
+    float fadeInTime{0.0f};
+    float fadeOutTime{0.0f};
+    bool loop{false};
+
+    std::string soundName;
+    int priority{0};
+
+    int characterId{NONE};
+    int expressionId{NONE};
+    int trackId{NONE};
+    int soundId{NONE};
+};
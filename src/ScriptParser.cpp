@@ -1,9 +1,69 @@
 #include "ScriptParser.hpp"
+#include "AssetPack.hpp"
+#include "CompiledScript.hpp"
+#include "ScriptReader.hpp"
+#include <filesystem>
+#include <set>
+#include <unordered_map>
+
+std::vector<std::string> ScriptParser::findScripts(const std::string& directory) {
+    std::vector<std::filesystem::path> entries;
+    for (const auto& name : AssetPack::getInstance().listFiles(directory)) {
+        entries.push_back(std::filesystem::path(directory) / name);
+    }
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(directory, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        entries.push_back(it->path());
+    }
+
+    std::set<std::string> scripts;
+    for (auto& entry : entries) {
+        if (entry.extension() == ".yaml") {
+            scripts.insert(entry.string());
+        } else if (entry.extension() == CompiledScript::EXTENSION) {
+            scripts.insert(entry.replace_extension(".yaml").string());
+        }
+    }
+    return {scripts.begin(), scripts.end()};
+}
+
+ScriptData ScriptParser::loadScript(const std::string& filename) {
+    if (ScriptData data; CompiledScript::load(CompiledScript::compiledPathFor(filename), filename, data)) {
+        return data;
+    }
+
+    std::error_code ec;
+    const AssetPack::Blob packed = AssetPack::getInstance().find(filename);
+    if (const auto size = packed ? packed.size : std::filesystem::file_size(filename, ec); !ec && size >= ScriptReader::STREAMING_THRESHOLD) {
+        ScriptData data;
+        if (auto reader = ScriptReader::open(filename, data)) {
+            std::vector<ScriptCommand> commands = reader->readChunk(ScriptReader::CHUNK_SIZE);
+            resolveReferences(data, commands, 0, data.errors);
+            data.commands.assign(commands);
+            data.reader = std::move(reader);
+            return data;
+        }
+    }
+    return parseScript(filename);
+}
 
 ScriptData ScriptParser::parseScript(const std::string& filename) {
     ScriptData data;
-    YAML::Node script = YAML::LoadFile(filename);
-    
+    const AssetPack::Blob packed = AssetPack::getInstance().find(filename);
+    const YAML::Node script = packed ? YAML::Load(std::string(packed.data, packed.size)) : YAML::LoadFile(filename);
+    parseHeader(script, data);
+
+    std::vector<ScriptCommand> commands;
+    for (const auto& cmd : script["script"]) {
+        commands.push_back(parseCommand(cmd));
+    }
+
+    resolveReferences(data, commands, 0, data.errors);
+    data.commands.assign(commands);
+    return data;
+}
+
+void ScriptParser::parseHeader(const YAML::Node& script, ScriptData& data) {
     data.sceneName = script["scene_name"].as<std::string>();
     if (script["background"]) {
         data.backgroundPath = script["background"].as<std::string>();
@@ -11,6 +71,10 @@ ScriptData ScriptParser::parseScript(const std::string& filename) {
         data.backgroundPath = "assets/default.png";
     }
 
+    if (script["keep_resident"]) {
+        data.keepResident = script["keep_resident"].as<bool>();
+    }
+
     if (script["font"]) {
         data.fontPath = "assets/resources/fonts/" + script["font"].as<std::string>();
     }
@@ -33,10 +97,6 @@ ScriptData ScriptParser::parseScript(const std::string& filename) {
         data.characterData[name] = charData;
     }
 
-    for (const auto& cmd : script["script"]) {
-        data.commands.push_back(parseCommand(cmd));
-    }
-
     if (script["next_scene"]) {
         data.nextScenePath = script["next_scene"].as<std::string>();
     } else {
@@ -55,7 +115,99 @@ ScriptData ScriptParser::parseScript(const std::string& filename) {
         }
     }
 
-    return data;
+    if (script["sounds"]) {
+        for (const auto& sound : script["sounds"]) {
+            ScriptData::SoundData soundData;
+            soundData.path = sound["path"].as<std::string>();
+            data.sounds[sound["name"].as<std::string>()] = soundData;
+        }
+    }
+}
+
+void ScriptParser::resolveReferences(const ScriptData& data, std::vector<ScriptCommand>& commands,
+                                     const std::size_t firstIndex, std::vector<std::string>& errors) {
+    struct CharacterIds {
+        int id{ScriptCommand::NONE};
+        std::unordered_map<std::string, int> expressions;
+    };
+
+    std::unordered_map<std::string, CharacterIds> characters;
+    for (const auto& [name, charData] : data.characterData) {
+        CharacterIds& ids = characters[name];
+        ids.id = static_cast<int>(characters.size()) - 1;
+        for (const auto& [expression, path] : charData.sprites) {
+            ids.expressions.emplace(expression, static_cast<int>(ids.expressions.size()));
+        }
+    }
+
+    std::unordered_map<std::string, int> tracks;
+    for (const auto& [name, musicData] : data.musicTracks) {
+        tracks.emplace(name, static_cast<int>(tracks.size()));
+    }
+
+    std::unordered_map<std::string, int> sounds;
+    for (const auto& [name, soundData] : data.sounds) {
+        sounds.emplace(name, static_cast<int>(sounds.size()));
+    }
+
+    const auto report = [&errors, firstIndex](const std::size_t index, const std::string& message) {
+        errors.push_back("command " + std::to_string(firstIndex + index + 1) + ": " + message);
+    };
+
+    for (std::size_t i = 0; i < commands.size(); ++i) {
+        ScriptCommand& cmd = commands[i];
+        cmd.characterId = ScriptCommand::NONE;
+        cmd.expressionId = ScriptCommand::NONE;
+        cmd.trackId = ScriptCommand::NONE;
+        cmd.soundId = ScriptCommand::NONE;
+
+        switch (cmd.type) {
+            case ScriptCommand::DIALOG:
+            case ScriptCommand::MOVE: {
+                const auto character = characters.find(cmd.character);
+                if (character == characters.end()) {
+                    if (cmd.type == ScriptCommand::MOVE) {
+                        report(i, "move references unknown character '" + cmd.character + "'");
+                    } else if (!cmd.expression.empty()) {
+                        report(i, "expression '" + cmd.expression + "' set on unknown character '" + cmd.character + "'");
+                    }
+                    break;
+                }
+                cmd.characterId = character->second.id;
+
+                if (!cmd.expression.empty()) {
+                    const auto expression = character->second.expressions.find(cmd.expression);
+                    if (expression == character->second.expressions.end()) {
+                        report(i, "character '" + cmd.character + "' has no expression '" + cmd.expression + "'");
+                    } else {
+                        cmd.expressionId = expression->second;
+                    }
+                }
+                break;
+            }
+
+            case ScriptCommand::MUSIC: {
+                if (cmd.musicName.empty()) {
+                    break;
+                }
+                if (const auto track = tracks.find(cmd.musicName); track != tracks.end()) {
+                    cmd.trackId = track->second;
+                } else {
+                    report(i, "unknown music track '" + cmd.musicName + "'");
+                }
+                break;
+            }
+
+            case ScriptCommand::SFX: {
+                if (const auto sound = sounds.find(cmd.soundName); sound != sounds.end()) {
+                    cmd.soundId = sound->second;
+                } else {
+                    report(i, "unknown sound '" + cmd.soundName + "'");
+                }
+                break;
+            }
+        }
+    }
 }
 
 ScriptCommand ScriptParser::parseCommand(const YAML::Node& node) {
@@ -100,6 +252,16 @@ ScriptCommand ScriptParser::parseCommand(const YAML::Node& node) {
             cmd.loop = node["loop"].as<bool>();
         }
     }
+    else if (type == "sfx") {
+        cmd.type = ScriptCommand::SFX;
+        cmd.soundName = node["sound"].as<std::string>();
+        if (node["volume"]) {
+            cmd.volume = node["volume"].as<float>();
+        }
+        if (node["priority"]) {
+            cmd.priority = node["priority"].as<int>();
+        }
+    }
 
     return cmd;
 }
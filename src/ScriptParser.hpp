@@ -3,34 +3,19 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <yaml-cpp/yaml.h>
+#include "ScriptCommand.hpp"
+#include "CommandStream.hpp"
 
-struct ScriptCommand {
-    enum Type {
-        DIALOG,
-        MOVE,
-        MUSIC
-    } type;
-    
-    std::string character;
-    std::string text;
-    std::string expression;
-    sf::Vector2f position;
-    float duration{0.0f};
-    bool smooth{true};
-    
-    std::string musicName;
-    float volume{100.0f};
-    float fadeInTime{0.0f};
-    float fadeOutTime{0.0f};
-    bool loop{false};
-};
+class ScriptReader;
 
 struct ScriptData {
     std::string sceneName;
     std::string backgroundPath;
     std::string nextScenePath;
     std::string fontPath{"assets/resources/fonts/arial.ttf"};
+    bool keepResident{false};
     struct CharacterData {
         std::map<std::string, std::string> sprites;
         sf::Vector2f initial_position;
@@ -42,13 +27,24 @@ struct ScriptData {
         bool loop{false};
     };
     std::map<std::string, MusicData> musicTracks;
+
+    struct SoundData {
+        std::string path;
+    };
+    std::map<std::string, SoundData> sounds;
     
-    std::vector<ScriptCommand> commands;
+    CommandStream commands;
+    std::shared_ptr<ScriptReader> reader;
+    std::vector<std::string> errors;
 };
 
 class ScriptParser {
 public:
+    static std::vector<std::string> findScripts(const std::string& directory);
+    static ScriptData loadScript(const std::string& filename);
     static ScriptData parseScript(const std::string& filename);
-private:
+    static void parseHeader(const YAML::Node& script, ScriptData& data);
     static ScriptCommand parseCommand(const YAML::Node& node);
+    static void resolveReferences(const ScriptData& data, std::vector<ScriptCommand>& commands,
+                                  std::size_t firstIndex, std::vector<std::string>& errors);
 };
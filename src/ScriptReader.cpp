@@ -0,0 +1,162 @@
+#include "ScriptReader.hpp"
+#include <stdexcept>
+
+namespace {
+    std::string_view lineAt(const std::string_view text, const std::size_t pos, std::size_t& next) {
+        std::size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = text.size();
+            next = end;
+        } else {
+            next = end + 1;
+        }
+        std::string_view line = text.substr(pos, end - pos);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    bool isBlankOrComment(const std::string_view line) {
+        const std::size_t first = line.find_first_not_of(" \t");
+        return first == std::string_view::npos || line[first] == '#';
+    }
+
+    bool isUnsupportedTopLevel(const std::string_view line) {
+        return line.substr(0, 3) == "---" || line.substr(0, 3) == "..." ||
+               (!line.empty() && (line[0] == '{' || line[0] == '[' || line[0] == '?'));
+    }
+
+    std::string_view topLevelKey(const std::string_view line) {
+        if (line.empty() || line[0] == ' ' || line[0] == '\t' || line[0] == '#' || line[0] == '-') {
+            return {};
+        }
+        const std::size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            return {};
+        }
+        std::string_view key = line.substr(0, colon);
+        while (!key.empty() && (key.back() == ' ' || key.back() == '\t')) {
+            key.remove_suffix(1);
+        }
+        if (key.size() >= 2 && (key.front() == '"' || key.front() == '\'') && key.back() == key.front()) {
+            key = key.substr(1, key.size() - 2);
+        }
+        return key;
+    }
+}
+
+std::shared_ptr<ScriptReader> ScriptReader::open(const std::string& filename, ScriptData& header) {
+    std::shared_ptr<ScriptReader> reader(new ScriptReader());
+    reader->source = AssetPack::getInstance().find(filename);
+    if (!reader->source) {
+        if (!reader->file.open(filename)) {
+            return nullptr;
+        }
+        reader->source = {reader->file.getData(), reader->file.getSize()};
+    }
+    reader->path = filename;
+
+    const std::string_view text = reader->text();
+    std::size_t pos = text.substr(0, 3) == "\xEF\xBB\xBF" ? 3 : 0;
+    std::size_t sectionBegin = std::string_view::npos;
+    bool inScript = false;
+
+    while (pos < text.size()) {
+        std::size_t next = 0;
+        const std::string_view line = lineAt(text, pos, next);
+        if (isUnsupportedTopLevel(line)) {
+            return nullptr;
+        }
+
+        if (const std::string_view key = topLevelKey(line); !key.empty()) {
+            if (inScript) {
+                reader->scriptEnd = pos;
+                inScript = false;
+            }
+            if (key == "script") {
+                if (sectionBegin != std::string_view::npos ||
+                    !isBlankOrComment(line.substr(line.find(':') + 1))) {
+                    return nullptr;
+                }
+                sectionBegin = pos;
+                reader->scriptBegin = next;
+                inScript = true;
+            }
+        }
+        pos = next;
+    }
+    if (inScript) {
+        reader->scriptEnd = text.size();
+    }
+
+    if (sectionBegin == std::string_view::npos) {
+        reader->scriptBegin = reader->scriptEnd = text.size();
+        sectionBegin = text.size();
+    }
+
+    reader->position = reader->scriptEnd;
+    for (pos = reader->scriptBegin; pos < reader->scriptEnd;) {
+        std::size_t next = 0;
+        const std::string_view line = lineAt(text, pos, next);
+        if (!isBlankOrComment(line)) {
+            reader->itemIndent = line.find_first_not_of(' ');
+            if (line[reader->itemIndent] != '-') {
+                return nullptr;
+            }
+            reader->position = reader->scriptBegin;
+            break;
+        }
+        pos = next;
+    }
+
+    std::string headerText(text.substr(0, sectionBegin));
+    headerText += text.substr(reader->scriptEnd);
+    ScriptParser::parseHeader(YAML::Load(headerText), header);
+    return reader;
+}
+
+bool ScriptReader::isItemStart(const std::string_view line) const {
+    return line.size() > itemIndent &&
+           line.find_first_not_of(' ') == itemIndent &&
+           line[itemIndent] == '-' &&
+           (line.size() == itemIndent + 1 || line[itemIndent + 1] == ' ' || line[itemIndent + 1] == '\t');
+}
+
+std::vector<ScriptCommand> ScriptReader::readChunk(const std::size_t count) {
+    std::vector<ScriptCommand> commands;
+    if (isFinished() || count == 0) {
+        return commands;
+    }
+
+    const std::string_view source = text();
+    std::size_t pos = position;
+    std::size_t items = 0;
+    while (pos < scriptEnd) {
+        std::size_t next = 0;
+        if (isItemStart(lineAt(source, pos, next))) {
+            if (items == count) {
+                break;
+            }
+            ++items;
+        }
+        pos = next;
+    }
+
+    const std::string chunk(source.substr(position, pos - position));
+    position = pos;
+
+    const YAML::Node nodes = YAML::Load(chunk);
+    if (items > 0 && !nodes.IsSequence()) {
+        throw std::runtime_error("malformed script section");
+    }
+    commands.reserve(items);
+    for (const auto& node : nodes) {
+        commands.push_back(ScriptParser::parseCommand(node));
+    }
+    return commands;
+}
+
+void ScriptReader::rewind() {
+    position = scriptBegin;
+}
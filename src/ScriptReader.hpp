@@ -0,0 +1,35 @@
+#pragma once
+#include "AssetPack.hpp"
+#include "MappedFile.hpp"
+#include "ScriptParser.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ScriptReader {
+public:
+    static constexpr std::size_t STREAMING_THRESHOLD = 512 * 1024;
+    static constexpr std::size_t CHUNK_SIZE = 256;
+
+    static std::shared_ptr<ScriptReader> open(const std::string& filename, ScriptData& header);
+
+    std::vector<ScriptCommand> readChunk(std::size_t count);
+    void rewind();
+    bool isFinished() const { return position >= scriptEnd; }
+    const std::string& getPath() const { return path; }
+
+private:
+    ScriptReader() = default;
+
+    std::string_view text() const { return {source.data, source.size}; }
+    bool isItemStart(std::string_view line) const;
+
+    MappedFile file;
+    AssetPack::Blob source;
+    std::string path;
+    std::size_t scriptBegin{0};
+    std::size_t scriptEnd{0};
+    std::size_t itemIndent{0};
+    std::size_t position{0};
+};
@@ -1,57 +1,187 @@
 #include "ScriptedScene.hpp"
+#include "AssetPack.hpp"
+#include <algorithm>
 #include <filesystem>
 #include "FontGenerator.hpp"
-#include "Game.hpp"
+#include "Hash.hpp"
+#include "Profiler.hpp"
+#include "ScriptReader.hpp"
 
-ScriptedScene::ScriptedScene(const std::string& scriptPath, Game* gameInstance) 
-    : game(gameInstance) {
-    ScriptParser parser;
-    scriptData = parser.parseScript(scriptPath);
+ScriptedScene::ScriptedScene(const std::string& scriptPath)
+    : ScriptedScene(prepare(scriptPath)) {
+}
 
-    if (!FontGenerator::getInstance().generateBitmapFont(scriptData.fontPath, 24)) {
-        std::cerr << "Failed to load font " << scriptData.fontPath << ", falling back to default\n";
-        if (!FontGenerator::getInstance().generateBitmapFont("assets/resources/fonts/arial.ttf", 24)) {
-            std::cerr << "Failed to load default font!\n";
+ScriptedScene::ScriptedScene(PreparedScene&& prepared)
+    : scriptData(std::move(prepared.scriptData)) {
+    VN_PROFILE_SCOPE("ScriptedScene::construct");
+    if (TextureCache::Handle texture = acquireTexture(resolveBackgroundPath(scriptData.backgroundPath), prepared.images)) {
+        setBackground(std::move(texture));
+    }
+    initializeCharacters(prepared);
+
+    for (const auto& [trackName, trackData] : scriptData.musicTracks) {
+        if (auto opened = prepared.music.find(trackName); opened != prepared.music.end()) {
+            musicManager.addTrack(trackName, trackData.path, trackData.loop, std::move(opened->second));
+        } else {
+            musicManager.loadTrack(trackName, trackData.path, trackData.loop);
+        }
+    }
+    for (const auto& [soundName, soundData] : scriptData.sounds) {
+        soundManager.addSound(soundName, soundData.path);
+    }
+}
+
+PreparedScene ScriptedScene::prepare(const std::string& scriptPath) {
+    VN_PROFILE_SCOPE("ScriptedScene::prepare");
+    PreparedScene prepared;
+    prepared.scriptPath = scriptPath;
+    prepared.scriptData = ScriptParser::loadScript(scriptPath);
+    for (const auto& error : prepared.scriptData.errors) {
+        std::cerr << scriptPath << ": " << error << std::endl;
+    }
+
+    TextureCache& cache = TextureCache::getInstance();
+    std::vector<std::string> paths{resolveBackgroundPath(prepared.scriptData.backgroundPath)};
+    for (const auto& [charName, charData] : prepared.scriptData.characterData) {
+        PreparedAtlas atlas;
+        atlas.key = atlasKeyFor(charName, charData);
+        if ((atlas.atlas = cache.findAtlas(atlas.key))) {
+            prepared.atlases.emplace(charName, std::move(atlas));
+            continue;
+        }
+
+        std::map<std::string, sf::Image> sprites;
+        for (const auto& [exprName, texturePath] : charData.sprites) {
+            if (sf::Image image; !sprites.count(texturePath) && AssetPack::getInstance().loadImage(texturePath, image)) {
+                sprites.emplace(texturePath, std::move(image));
+            }
+        }
+        if (TextureCache::packAtlas(sprites, atlas.image, atlas.frames)) {
+            prepared.atlases.emplace(charName, std::move(atlas));
+            continue;
+        }
+        for (auto& [texturePath, image] : sprites) {
+            prepared.images.emplace(texturePath, std::move(image));
+        }
+    }
+
+    for (const auto& path : paths) {
+        if (prepared.images.count(path) || cache.contains(path)) {
+            continue;
+        }
+        if (sf::Image image; AssetPack::getInstance().loadImage(path, image)) {
+            prepared.images.emplace(path, std::move(image));
+        }
+    }
+
+    for (const auto& [trackName, trackData] : prepared.scriptData.musicTracks) {
+        prepared.music.emplace(trackName, MusicManager::openTrack(trackData.path));
+    }
+
+    const CommandStream& commands = prepared.scriptData.commands;
+    const std::size_t soundEnd = std::min(commands.getEndIndex(), commands.getFirstIndex() + SOUND_LOOKAHEAD);
+    for (std::size_t index = commands.getFirstIndex(); index < soundEnd; ++index) {
+        if (commands.getType(index) != ScriptCommand::SFX) {
+            continue;
+        }
+        const auto sound = prepared.scriptData.sounds.find(std::string(commands.getString(commands.getSfx(index).sound)));
+        if (sound != prepared.scriptData.sounds.end()) {
+            SoundBufferCache::getInstance().preload(sound->second.path);
         }
     }
-    
-    std::filesystem::path bgPath(scriptData.backgroundPath);
+
+    return prepared;
+}
+
+std::string ScriptedScene::resolveBackgroundPath(const std::string& backgroundPath) {
+    std::filesystem::path bgPath(backgroundPath);
     if (!bgPath.is_absolute()) {
         bgPath = std::filesystem::current_path() / bgPath;
     }
+    return bgPath.string();
+}
 
-    if (!backgroundTexture.loadFromFile(bgPath.string())) {
-        sf::Image fallbackImg({1920u, 1080u}, sf::Color(50, 50, 50));
-        backgroundTexture.loadFromImage(fallbackImg);
-    }
-    
-    setBackground(backgroundTexture);
-    initializeCharacters();
+TextureCache::Handle ScriptedScene::acquireTexture(const std::string& path, const std::map<std::string, sf::Image>& images) {
+    TextureCache& cache = TextureCache::getInstance();
+    const auto image = images.find(path);
+    return image != images.end() ? cache.acquire(path, image->second) : cache.acquire(path);
+}
 
-    for (const auto& [trackName, trackData] : scriptData.musicTracks) {
-        musicManager.loadTrack(trackName, trackData.path, trackData.loop);
+std::string ScriptedScene::atlasKeyFor(const std::string& characterName, const ScriptData::CharacterData& characterData) {
+    std::string paths;
+    for (const auto& [exprName, texturePath] : characterData.sprites) {
+        paths += texturePath;
+        paths += '\n';
     }
+    return "atlas:" + characterName + ":" + std::to_string(hashString(paths));
 }
 
-void ScriptedScene::initializeCharacters() {
+void ScriptedScene::initializeCharacters(PreparedScene& prepared) {
     for (const auto& [charName, charData] : scriptData.characterData) {
+        TextureCache::AtlasHandle atlas;
+        if (auto packed = prepared.atlases.find(charName); packed != prepared.atlases.end()) {
+            PreparedAtlas& source = packed->second;
+            atlas = source.atlas ? source.atlas
+                                 : TextureCache::getInstance().acquireAtlas(source.key, source.image, std::move(source.frames));
+        }
+
         Character character(charName);
         for (const auto& [exprName, texturePath] : charData.sprites) {
-            if (sf::Texture texture; texture.loadFromFile(texturePath)) {
-                character.addExpression(exprName, texture);
+            const sf::Vector2f textureScale = AssetPack::getInstance().find(texturePath).scale;
+            if (atlas && atlas->frames.count(texturePath)) {
+                character.addExpression(exprName, TextureCache::atlasTexture(atlas), atlas->frames.at(texturePath), textureScale);
+            } else {
+                character.addExpression(exprName, acquireTexture(texturePath, prepared.images), textureScale);
             }
         }
-        character.setPosition(charData.initial_position);
+        character.setInitialPosition(charData.initial_position);
         addCharacter(std::move(character));
     }
 }
 
+void ScriptedScene::loadFont() {
+    if (!FontGenerator::getInstance().generateBitmapFont(scriptData.fontPath, 24)) {
+        std::cerr << "Failed to load font " << scriptData.fontPath << ", falling back to default\n";
+        if (!FontGenerator::getInstance().generateBitmapFont("assets/resources/fonts/arial.ttf", 24)) {
+            std::cerr << "Failed to load default font!\n";
+        }
+    }
+}
+
 void ScriptedScene::load() {
+    if (scriptData.reader && currentCommand > 0) {
+        if (pendingCommands.valid()) {
+            pendingCommands.wait();
+        }
+        pendingCommands = {};
+        scriptData.reader->rewind();
+        scriptData.commands.clear();
+    }
+
     currentCommand = 0;
+    soundScanIndex = 0;
     commandInProgress = false;
     commandTimer = 0.0f;
     sceneInitialized = false;
+    advanceWasPressed = true;
+
+    for (auto& character : characters) {
+        character.resetPosition();
+    }
+
     Scene::load();
+    prepareDialogLines();
+}
+
+std::size_t ScriptedScene::estimateMemoryUsage(TextureCache::CountedTextures& countedTextures) const {
+    std::size_t bytes = Scene::estimateMemoryUsage(countedTextures) + sizeof(*this) - sizeof(Scene);
+    bytes += scriptData.commands.getMemoryUsage();
+    bytes += dialog.getPreparedMemoryUsage();
+    return bytes;
+}
+
+bool ScriptedScene::isAnimating() const {
+    return Scene::isAnimating() || !sceneInitialized || commandInProgress || musicManager.isFading();
 }
 
 void ScriptedScene::update(const float deltaTime) {
@@ -64,27 +194,14 @@ void ScriptedScene::update(const float deltaTime) {
         return;
     }
 
-    if (commandInProgress && currentCommand <= scriptData.commands.size()) {
-        const auto& cmd = scriptData.commands[currentCommand - 1];
-        if (processCommand(cmd, deltaTime)) {
+    if (commandInProgress && currentCommand > scriptData.commands.getFirstIndex() &&
+        currentCommand <= scriptData.commands.getEndIndex()) {
+        if (processCommand(currentCommand - 1, deltaTime)) {
             commandInProgress = false;
         }
     }
 
-    if (!game || !game->isWindowActive()) {
-        return;
-    }
-
-    static bool spaceWasPressed = false;
-    static bool mouseWasPressed = false;
-
-    bool spacePressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space);
-    bool mousePressed = sf::Mouse::isButtonPressed(sf::Mouse::Button::Left);
-    bool ctrlPressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl) || 
-                      sf::Keyboard::isKeyPressed(sf::Keyboard::Key::RControl);
-    bool rightMousePressed = sf::Mouse::isButtonPressed(sf::Mouse::Button::Right);
-
-    if (ctrlPressed || rightMousePressed) {
+    if (input.skip) {
         if (dialog.isAnimationComplete()) {
             completeCurrentAnimations();
             executeNextCommand();
@@ -92,8 +209,8 @@ void ScriptedScene::update(const float deltaTime) {
             completeCurrentAnimations();
         }
     }
-    else if (spacePressed || mousePressed) {
-        if (!spaceWasPressed && !mouseWasPressed) {
+    else if (input.advance) {
+        if (!advanceWasPressed) {
             if (dialog.isAnimationComplete()) {
                 if (dialog.canAdvance()) {
                     completeCurrentAnimations();
@@ -102,38 +219,33 @@ void ScriptedScene::update(const float deltaTime) {
             } else {
                 completeCurrentAnimations();
             }
-            spaceWasPressed = spacePressed;
-            mouseWasPressed = mousePressed;
+            advanceWasPressed = true;
         }
     } else {
-        spaceWasPressed = false;
-        mouseWasPressed = false;
+        advanceWasPressed = false;
     }
 }
 
 void ScriptedScene::completeCurrentCommand() {
-    if (currentCommand <= scriptData.commands.size()) {
-        const auto& cmd = scriptData.commands[currentCommand - 1];
-        if (cmd.type == ScriptCommand::MOVE) {
-            for (auto& character : characters) {
-                if (character.getName() == cmd.character) {
-                    character.setPosition(cmd.position);
-                    break;
-                }
-            }
+    if (currentCommand > scriptData.commands.getFirstIndex() && currentCommand <= scriptData.commands.getEndIndex() &&
+        scriptData.commands.getType(currentCommand - 1) == ScriptCommand::MOVE) {
+        const auto& move = scriptData.commands.getMove(currentCommand - 1);
+        if (Character* character = findCharacter(move.characterId)) {
+            character->setPosition(move.position);
         }
     }
 }
 
 void ScriptedScene::executeNextCommand() {
-    if (currentCommand > scriptData.commands.size()) return;
+    if (isComplete()) return;
     commandInProgress = false;
     commandTimer = 0.0f;
-    if (currentCommand < scriptData.commands.size()) {
-        const auto& cmd = scriptData.commands[currentCommand];
-        bool finishedNow = processCommand(cmd, 0.0f); 
+    if (ensureCommand(currentCommand)) {
+        preloadSounds();
+        bool finishedNow = processCommand(currentCommand, 0.0f);
         commandInProgress = !finishedNow;
-        if (finishedNow && cmd.type == ScriptCommand::MUSIC) {
+        const ScriptCommand::Type type = scriptData.commands.getType(currentCommand);
+        if (finishedNow && (type == ScriptCommand::MUSIC || type == ScriptCommand::SFX)) {
             currentCommand++;
             executeNextCommand();
             return;
@@ -142,64 +254,77 @@ void ScriptedScene::executeNextCommand() {
     currentCommand++;
 }
 
-bool ScriptedScene::processCommand(const ScriptCommand& cmd, const float deltaTime) {
-    switch (cmd.type) {
-        case ScriptCommand::DIALOG: {
-            const std::string lines = cmd.text;
-            setDialogLines(lines);
+void ScriptedScene::prepareDialogLines() {
+    const CommandStream& commands = scriptData.commands;
+    std::vector<std::pair<std::size_t, std::string_view>> lines;
+    for (std::size_t index = commands.getFirstIndex(); index < commands.getEndIndex(); ++index) {
+        if (commands.getType(index) == ScriptCommand::DIALOG) {
+            lines.emplace_back(index, commands.getString(commands.getDialog(index).text));
+        }
+    }
+    dialog.prepareLines(lines);
+}
 
-            if (!cmd.character.empty()) {
-                dialog.setCharacterName(cmd.character);
-            } else {
-                dialog.setCharacterName("");
-            }
+void ScriptedScene::preloadSounds() {
+    const CommandStream& commands = scriptData.commands;
+    const std::size_t end = std::min(commands.getEndIndex(), currentCommand + SOUND_LOOKAHEAD);
+    for (std::size_t index = std::max({soundScanIndex, commands.getFirstIndex(), currentCommand}); index < end; ++index) {
+        if (commands.getType(index) == ScriptCommand::SFX && commands.getSfx(index).soundId != ScriptCommand::NONE) {
+            soundManager.preload(static_cast<std::size_t>(commands.getSfx(index).soundId));
+        }
+    }
+    soundScanIndex = std::max(soundScanIndex, end);
+}
+
+bool ScriptedScene::processCommand(const std::size_t index, const float deltaTime) {
+    VN_PROFILE_SCOPE("ScriptedScene::processCommand");
+    const CommandStream& commands = scriptData.commands;
+    switch (commands.getType(index)) {
+        case ScriptCommand::DIALOG: {
+            const auto& cmd = commands.getDialog(index);
+            dialog.addLine(std::string(commands.getString(cmd.text)), index);
+            dialog.setCharacterName(std::string(commands.getString(cmd.character)));
 
             commandInProgress = false;
-            if (!cmd.expression.empty()) {
-                for (auto& character : characters) {
-                    if (character.getName() == cmd.character) {
-                        character.setExpression(cmd.expression);
-                        break;
-                    }
-                }
+            if (Character* character = findCharacter(cmd.characterId); character && cmd.expressionId != ScriptCommand::NONE) {
+                character->setExpression(static_cast<std::size_t>(cmd.expressionId));
             }
             return true;
         }
         
         case ScriptCommand::MOVE: {
-            for (auto& character : characters) {
-                if (character.getName() == cmd.character) {
-                    bool skipAnimation = sf::Mouse::isButtonPressed(sf::Mouse::Button::Right) ||
-                                       sf::Keyboard::isKeyPressed(sf::Keyboard::Key::LControl) ||
-                                       sf::Keyboard::isKeyPressed(sf::Keyboard::Key::RControl);
-
-                    if (cmd.duration > 0 && cmd.smooth && !skipAnimation) {
-                        commandTimer += deltaTime;
-                        float progress = std::min(commandTimer / cmd.duration, 1.0f);
-                        const sf::Vector2f currentPos = character.getPosition();
-                        const sf::Vector2f targetPos = cmd.position;
-                        const sf::Vector2f newPos = currentPos + (targetPos - currentPos) * progress;
-                        character.setPosition(newPos);
-                        return progress >= 1.0f;
-                    }
-                    character.setPosition(cmd.position);
-                    return true;
-                }
+            const auto& cmd = commands.getMove(index);
+            Character* character = findCharacter(cmd.characterId);
+            if (!character) {
+                return true;
+            }
+            if (cmd.duration > 0 && cmd.smooth && !input.skip) {
+                commandTimer += deltaTime;
+                float progress = std::min(commandTimer / cmd.duration, 1.0f);
+                const sf::Vector2f currentPos = character->getPosition();
+                const sf::Vector2f targetPos = cmd.position;
+                const sf::Vector2f newPos = currentPos + (targetPos - currentPos) * progress;
+                character->setPosition(newPos);
+                return progress >= 1.0f;
             }
+            character->setPosition(cmd.position);
             return true;
         }
         
-        
         case ScriptCommand::MUSIC: {
-            if (cmd.musicName.empty()) {
+            const auto& cmd = commands.getMusic(index);
+            if (cmd.track.length == 0) {
                 musicManager.stopMusic(cmd.fadeOutTime);
-            } else {
-                auto it = scriptData.musicTracks.find(cmd.musicName);
-                if (it != scriptData.musicTracks.end()) {
-                    bool shouldLoop = cmd.loop;
-                    musicManager.loadTrack(cmd.musicName, it->second.path, shouldLoop);
-                }
-                musicManager.playTrack(cmd.musicName, cmd.volume, cmd.fadeInTime, cmd.fadeOutTime);
+            } else if (cmd.trackId != ScriptCommand::NONE) {
+                musicManager.playTrack(static_cast<std::size_t>(cmd.trackId), cmd.volume, cmd.fadeInTime, cmd.fadeOutTime, cmd.loop);
+            }
+            return true;
+        }
+
+        case ScriptCommand::SFX: {
+            const auto& cmd = commands.getSfx(index);
+            if (cmd.soundId != ScriptCommand::NONE) {
+                soundManager.play(static_cast<std::size_t>(cmd.soundId), cmd.volume, cmd.priority);
             }
             return true;
         }
@@ -209,6 +334,68 @@ bool ScriptedScene::processCommand(const ScriptCommand& cmd, const float deltaTi
     }
 }
 
+bool ScriptedScene::isComplete() const {
+    return currentCommand > scriptData.commands.getEndIndex() && !hasMoreCommands();
+}
+
+bool ScriptedScene::hasMoreCommands() const {
+    return pendingCommands.valid() || (scriptData.reader && !scriptData.reader->isFinished());
+}
+
+bool ScriptedScene::ensureCommand(const std::size_t index) {
+    while (index >= scriptData.commands.getEndIndex() && hasMoreCommands()) {
+        requestCommands();
+        receiveCommands();
+    }
+    if (pendingCommands.valid() && pendingCommands.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        receiveCommands();
+    }
+    if (scriptData.commands.getEndIndex() < index + ScriptReader::CHUNK_SIZE / 2) {
+        requestCommands();
+    }
+    return index < scriptData.commands.getEndIndex();
+}
+
+void ScriptedScene::requestCommands() {
+    const std::shared_ptr<ScriptReader> reader = scriptData.reader;
+    if (!reader || pendingCommands.valid() || reader->isFinished()) {
+        return;
+    }
+    pendingCommands = std::async(std::launch::async, [reader] {
+        return reader->readChunk(ScriptReader::CHUNK_SIZE);
+    });
+}
+
+void ScriptedScene::receiveCommands() {
+    std::vector<ScriptCommand> commands;
+    try {
+        commands = pendingCommands.get();
+    } catch (const std::exception& e) {
+        std::cerr << scriptData.reader->getPath() << ": " << e.what() << std::endl;
+        scriptData.reader.reset();
+        return;
+    }
+
+    CommandStream& stream = scriptData.commands;
+    std::vector<std::string> errors;
+    ScriptParser::resolveReferences(scriptData, commands, stream.getEndIndex(), errors);
+    for (const auto& error : errors) {
+        std::cerr << scriptData.reader->getPath() << ": " << error << std::endl;
+    }
+
+    stream.discardBefore(std::min(currentCommand > 0 ? currentCommand - 1 : 0, stream.getEndIndex()));
+    for (const auto& cmd : commands) {
+        stream.append(cmd);
+    }
+}
+
+Character* ScriptedScene::findCharacter(const int characterId) {
+    if (characterId == ScriptCommand::NONE || static_cast<std::size_t>(characterId) >= characters.size()) {
+        return nullptr;
+    }
+    return &characters[static_cast<std::size_t>(characterId)];
+}
+
 void ScriptedScene::completeCurrentAnimations() {
     dialog.completeAnimation();
     completeCurrentCommand();
@@ -216,4 +403,5 @@ void ScriptedScene::completeCurrentAnimations() {
 
 ScriptedScene::~ScriptedScene() {
     musicManager.stopMusic(0.0f);
+    soundManager.stopAll();
 }
\ No newline at end of file
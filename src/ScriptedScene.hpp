@@ -2,35 +2,72 @@
 #include "Scene.hpp"
 #include "ScriptParser.hpp"
 #include "MusicManager.hpp"
+#include "SoundManager.hpp"
+#include "TextureCache.hpp"
+#include <future>
 
-class Game;
+struct PreparedAtlas {
+    std::string key;
+    TextureCache::AtlasHandle atlas;
+    sf::Image image;
+    std::map<std::string, sf::IntRect> frames;
+};
+
+struct PreparedScene {
+    std::string scriptPath;
+    ScriptData scriptData;
+    std::map<std::string, sf::Image> images;
+    std::map<std::string, PreparedAtlas> atlases;
+    std::map<std::string, std::unique_ptr<sf::Music>> music;
+};
 
 class ScriptedScene : public Scene {
+public:
+    static constexpr std::size_t SOUND_LOOKAHEAD = 32;
+
 private:
-    Game* game{nullptr};
     ScriptData scriptData;
     size_t currentCommand{0};
     bool commandInProgress{false};
-    sf::Texture backgroundTexture;
     float commandTimer{0.0f};
     MusicManager musicManager;
+    SoundManager soundManager;
+    std::size_t soundScanIndex{0};
     bool sceneInitialized{false};
+    bool advanceWasPressed{true};
+    std::future<std::vector<ScriptCommand>> pendingCommands;
 
 public:
-    explicit ScriptedScene(const std::string& scriptPath, Game* gameInstance);
+    explicit ScriptedScene(const std::string& scriptPath);
+    explicit ScriptedScene(PreparedScene&& prepared);
+    static PreparedScene prepare(const std::string& scriptPath);
     void load() override;
     ~ScriptedScene() override;
     void update(float deltaTime) override;
+    std::size_t estimateMemoryUsage(TextureCache::CountedTextures& countedTextures) const override;
+    bool shouldStayResident() const override { return scriptData.keepResident; }
+    bool isAnimating() const override;
     const ScriptData& getScriptData() const { return scriptData; }
-    bool isComplete() const { return currentCommand > scriptData.commands.size(); }
+    bool isComplete() const;
     bool isCommandInProgress() const { return commandInProgress; }
     void stopMusic() { musicManager.stopMusic(0.0f); }
     bool isSceneInitialized() const { return sceneInitialized; }
 
 private:
     void executeNextCommand();
+    void preloadSounds();
+    void prepareDialogLines();
     void completeCurrentCommand();
     void completeCurrentAnimations();
-    bool processCommand(const ScriptCommand& cmd, float deltaTime);
-    void initializeCharacters();
+    bool processCommand(std::size_t index, float deltaTime);
+    Character* findCharacter(int characterId);
+    bool hasMoreCommands() const;
+    bool ensureCommand(std::size_t index);
+    void requestCommands();
+    void receiveCommands();
+    void initializeCharacters(PreparedScene& prepared);
+    static std::string atlasKeyFor(const std::string& characterName, const ScriptData::CharacterData& characterData);
+    static std::string resolveBackgroundPath(const std::string& backgroundPath);
+    static TextureCache::Handle acquireTexture(const std::string& path, const std::map<std::string, sf::Image>& images);
+    void loadFont() override;
 };
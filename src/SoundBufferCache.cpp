@@ -0,0 +1,112 @@
+#include "SoundBufferCache.hpp"
+#include "AssetPack.hpp"
+#include "Profiler.hpp"
+#include <filesystem>
+#include <iostream>
+
+SoundBufferCache& SoundBufferCache::getInstance() {
+    static SoundBufferCache instance;
+    return instance;
+}
+
+SoundBufferCache::~SoundBufferCache() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeLoader.notify_all();
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+std::string SoundBufferCache::makeKey(const std::string& path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+SoundBufferCache::Handle SoundBufferCache::decode(const std::string& path) {
+    VN_PROFILE_SCOPE("SoundBufferCache::decode");
+    auto buffer = std::make_shared<sf::SoundBuffer>();
+    if (!AssetPack::getInstance().loadSoundBuffer(path, *buffer)) {
+        std::cerr << "Failed to load sound: " << path << std::endl;
+        return nullptr;
+    }
+    return buffer;
+}
+
+void SoundBufferCache::preload(const std::string& path) {
+    const std::string key = makeKey(path);
+    std::lock_guard lock(mutex);
+    if (entries.count(key) == 0) {
+        enqueue(key, path);
+    }
+}
+
+SoundBufferCache::Handle SoundBufferCache::acquire(const std::string& path) {
+    const std::string key = makeKey(path);
+    std::lock_guard lock(mutex);
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        enqueue(key, path);
+        return nullptr;
+    }
+    if (!it->second.loaded) {
+        return nullptr;
+    }
+    it->second.lastUse = ++useCounter;
+    return it->second.buffer;
+}
+
+void SoundBufferCache::enqueue(const std::string& key, const std::string& path) {
+    Entry& entry = entries[key];
+    entry.path = path;
+    entry.lastUse = ++useCounter;
+    pending.push_back(key);
+    if (!loader.joinable()) {
+        loader = std::thread(&SoundBufferCache::loaderLoop, this);
+    }
+    wakeLoader.notify_one();
+}
+
+void SoundBufferCache::loaderLoop() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        wakeLoader.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (stopping) {
+            return;
+        }
+        const std::string key = std::move(pending.front());
+        pending.pop_front();
+        const std::string path = entries.at(key).path;
+
+        lock.unlock();
+        Handle buffer = decode(path);
+        lock.lock();
+
+        Entry& entry = entries.at(key);
+        entry.buffer = std::move(buffer);
+        entry.loaded = true;
+        entry.bytes = entry.buffer ? sizeof(sf::SoundBuffer) +
+                                         static_cast<std::size_t>(entry.buffer->getSampleCount()) * sizeof(std::int16_t)
+                                   : 0;
+        usage += entry.bytes;
+        trim(key);
+    }
+}
+
+void SoundBufferCache::trim(const std::string& keep) {
+    while (usage > budget) {
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.bytes != 0 && it->second.buffer.use_count() == 1 && it->first != keep &&
+                (oldest == entries.end() || it->second.lastUse < oldest->second.lastUse)) {
+                oldest = it;
+            }
+        }
+        if (oldest == entries.end()) {
+            break;
+        }
+        usage -= oldest->second.bytes;
+        entries.erase(oldest);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <SFML/Audio/SoundBuffer.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifndef VN_SOUND_CACHE_MB
+#define VN_SOUND_CACHE_MB 32
+#endif
+
+class SoundBufferCache {
+public:
+    using Handle = std::shared_ptr<const sf::SoundBuffer>;
+
+    static SoundBufferCache& getInstance();
+
+    Handle acquire(const std::string& path);
+    void preload(const std::string& path);
+
+    SoundBufferCache(const SoundBufferCache&) = delete;
+    SoundBufferCache& operator=(const SoundBufferCache&) = delete;
+
+private:
+    SoundBufferCache() = default;
+    ~SoundBufferCache();
+
+    struct Entry {
+        std::string path;
+        Handle buffer;
+        bool loaded{false};
+        std::size_t bytes{0};
+        std::uint64_t lastUse{0};
+    };
+
+    static std::string makeKey(const std::string& path);
+    static Handle decode(const std::string& path);
+    void enqueue(const std::string& key, const std::string& path);
+    void loaderLoop();
+    void trim(const std::string& keep);
+
+    std::mutex mutex;
+    std::condition_variable wakeLoader;
+    std::unordered_map<std::string, Entry> entries;
+    std::deque<std::string> pending;
+    std::thread loader;
+    bool stopping{false};
+    std::size_t usage{0};
+    std::size_t budget{static_cast<std::size_t>(VN_SOUND_CACHE_MB) * 1024 * 1024};
+    std::uint64_t useCounter{0};
+};
@@ -0,0 +1,52 @@
+#include "SoundManager.hpp"
+#include <algorithm>
+
+std::size_t SoundManager::addSound(const std::string& name, const std::string& path) {
+    sounds.push_back({name, path});
+    return sounds.size() - 1;
+}
+
+void SoundManager::preload(const std::size_t soundId) const {
+    if (soundId < sounds.size()) {
+        SoundBufferCache::getInstance().preload(sounds[soundId].path);
+    }
+}
+
+bool SoundManager::play(const std::size_t soundId, const float volume, const int priority) {
+    if (soundId >= sounds.size()) {
+        return false;
+    }
+    SoundBufferCache::Handle buffer = SoundBufferCache::getInstance().acquire(sounds[soundId].path);
+    if (!buffer) {
+        return false;
+    }
+
+    const auto isFree = [](const Voice& voice) {
+        return !voice.sound || voice.sound->getStatus() != sf::SoundSource::Status::Playing;
+    };
+    auto voice = std::find_if(voices.begin(), voices.end(), isFree);
+    if (voice == voices.end()) {
+        voice = std::min_element(voices.begin(), voices.end(), [](const Voice& a, const Voice& b) {
+            return a.priority != b.priority ? a.priority < b.priority : a.started < b.started;
+        });
+        if (voice->priority > priority) {
+            return false;
+        }
+    }
+
+    voice->sound.reset();
+    voice->buffer = std::move(buffer);
+    voice->sound.emplace(*voice->buffer);
+    voice->sound->setVolume(volume);
+    voice->sound->play();
+    voice->priority = priority;
+    voice->started = ++playCounter;
+    return true;
+}
+
+void SoundManager::stopAll() {
+    for (auto& voice : voices) {
+        voice.sound.reset();
+        voice.buffer.reset();
+    }
+}
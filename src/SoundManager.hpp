@@ -0,0 +1,35 @@
+#pragma once
+#include <SFML/Audio/Sound.hpp>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "SoundBufferCache.hpp"
+
+class SoundManager {
+public:
+    static constexpr std::size_t VOICE_COUNT = 8;
+
+    std::size_t addSound(const std::string& name, const std::string& path);
+    void preload(std::size_t soundId) const;
+    bool play(std::size_t soundId, float volume = 100.f, int priority = 0);
+    void stopAll();
+
+private:
+    struct SoundInfo {
+        std::string name;
+        std::string path;
+    };
+
+    struct Voice {
+        SoundBufferCache::Handle buffer;
+        std::optional<sf::Sound> sound;
+        int priority{0};
+        std::uint64_t started{0};
+    };
+
+    std::vector<SoundInfo> sounds;
+    std::array<Voice, VOICE_COUNT> voices;
+    std::uint64_t playCounter{0};
+};
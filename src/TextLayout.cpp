@@ -0,0 +1,341 @@
+#include "TextLayout.hpp"
+#include "FontGenerator.hpp"
+#include "Parallel.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+    constexpr std::uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+    int hexValue(const char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    std::uint64_t pairKey(const std::uint32_t first, const std::uint32_t second) {
+        return (static_cast<std::uint64_t>(first) << 32) | second;
+    }
+
+    class LiveMetrics {
+    public:
+        explicit LiveMetrics(FontGenerator& generator) : fontGenerator(generator) {}
+        const float* advance(const std::uint32_t c) const {
+            const FontGenerator::GlyphInfo* glyphInfo = fontGenerator.getGlyphInfo(c);
+            return glyphInfo ? &glyphInfo->advance : nullptr;
+        }
+        float kerning(const std::uint32_t first, const std::uint32_t second) const {
+            return fontGenerator.getKerning(first, second);
+        }
+
+    private:
+        FontGenerator& fontGenerator;
+    };
+
+    class MetricsSnapshot {
+    public:
+        std::unordered_map<std::uint32_t, float> advances;
+        std::unordered_map<std::uint64_t, float> kernings;
+
+        const float* advance(const std::uint32_t c) const {
+            const auto it = advances.find(c);
+            return it != advances.end() ? &it->second : nullptr;
+        }
+        float kerning(const std::uint32_t first, const std::uint32_t second) const {
+            const auto it = kernings.find(pairKey(first, second));
+            return it != kernings.end() ? it->second : 0.0f;
+        }
+    };
+}
+
+std::optional<sf::Color> TextLayout::parseColor(const std::string_view value) {
+    static const std::pair<std::string_view, sf::Color> NAMED_COLORS[] = {
+        {"white", sf::Color::White}, {"black", sf::Color::Black}, {"red", sf::Color::Red},
+        {"green", sf::Color::Green}, {"blue", sf::Color::Blue}, {"yellow", sf::Color::Yellow},
+        {"magenta", sf::Color::Magenta}, {"cyan", sf::Color::Cyan},
+        {"orange", sf::Color(255, 165, 0)}, {"gray", sf::Color(128, 128, 128)}, {"grey", sf::Color(128, 128, 128)},
+    };
+    for (const auto& [name, color] : NAMED_COLORS) {
+        if (value == name) {
+            return color;
+        }
+    }
+
+    if (value.size() != 7 && value.size() != 9) {
+        return std::nullopt;
+    }
+    if (value[0] != '#') {
+        return std::nullopt;
+    }
+    std::uint8_t channels[4] = {0, 0, 0, 255};
+    for (std::size_t i = 1; i < value.size(); i += 2) {
+        const int high = hexValue(value[i]);
+        const int low = hexValue(value[i + 1]);
+        if (high < 0 || low < 0) {
+            return std::nullopt;
+        }
+        channels[i / 2] = static_cast<std::uint8_t>(high * 16 + low);
+    }
+    return sf::Color(channels[0], channels[1], channels[2], channels[3]);
+}
+
+void TextLayout::clear() {
+    text.clear();
+    colorChanges.clear();
+    glyphs.clear();
+    runs.clear();
+    pen = {0.0f, 0.0f};
+    lineCount = 0;
+    width = 0.0f;
+}
+
+bool TextLayout::parseTag(const std::string_view utf8, std::size_t& offset) {
+    const std::size_t close = utf8.find(']', offset);
+    if (close == std::string_view::npos) {
+        return false;
+    }
+    const std::string_view tag = utf8.substr(offset + 1, close - offset - 1);
+    if (tag == "/color") {
+        if (colorStack.empty()) {
+            return false;
+        }
+        colorStack.pop_back();
+        colorChanges.push_back({text.size(), colorStack.empty() ? sf::Color::White : colorStack.back()});
+    } else if (tag.substr(0, 6) == "color=") {
+        const std::optional<sf::Color> color = parseColor(tag.substr(6));
+        if (!color) {
+            return false;
+        }
+        colorStack.push_back(*color);
+        colorChanges.push_back({text.size(), *color});
+    } else {
+        return false;
+    }
+    offset = close + 1;
+    return true;
+}
+
+void TextLayout::decode(const std::string_view utf8) {
+    text.clear();
+    colorChanges.clear();
+    colorStack.clear();
+
+    std::size_t offset = 0;
+    while (offset < utf8.size()) {
+        if (utf8[offset] == '[' && parseTag(utf8, offset)) {
+            continue;
+        }
+
+        const auto lead = static_cast<unsigned char>(utf8[offset]);
+        std::uint32_t codepoint = lead;
+        std::size_t length = 1;
+        if (lead >= 0x80) {
+            if ((lead >> 5) == 0x6) {
+                codepoint = lead & 0x1F;
+                length = 2;
+            } else if ((lead >> 4) == 0xE) {
+                codepoint = lead & 0x0F;
+                length = 3;
+            } else if ((lead >> 3) == 0x1E) {
+                codepoint = lead & 0x07;
+                length = 4;
+            } else {
+                codepoint = REPLACEMENT_CHARACTER;
+            }
+            for (std::size_t i = 1; i < length; ++i) {
+                const auto next = offset + i < utf8.size() ? static_cast<unsigned char>(utf8[offset + i]) : 0;
+                if ((next & 0xC0) != 0x80) {
+                    codepoint = REPLACEMENT_CHARACTER;
+                    length = i;
+                    break;
+                }
+                codepoint = (codepoint << 6) | (next & 0x3F);
+            }
+            if (codepoint > 0x10FFFF) {
+                codepoint = REPLACEMENT_CHARACTER;
+            }
+        }
+        offset += length;
+
+        if (codepoint == '\t') {
+            codepoint = ' ';
+        }
+        if (codepoint >= 32 || codepoint == '\n') {
+            text.push_back(codepoint);
+        }
+    }
+}
+
+void TextLayout::startRun(const sf::Color color) {
+    if (!runs.empty() && runs.back().count == 0) {
+        runs.back().color = color;
+        return;
+    }
+    runs.push_back({glyphs.size(), 0, color});
+}
+
+void TextLayout::breakLine(const std::size_t first, const float lineHeight) {
+    const float shift = first < glyphs.size() ? glyphs[first].position.x : pen.x;
+    width = std::max(width, shift);
+    for (std::size_t i = first; i < glyphs.size(); ++i) {
+        glyphs[i].position.x -= shift;
+        glyphs[i].position.y += lineHeight;
+    }
+    pen.x -= shift;
+    pen.y += lineHeight;
+    ++lineCount;
+}
+
+void TextLayout::layout(const std::string_view utf8, const float maxWidth, const float lineHeight) {
+    VN_PROFILE_SCOPE("TextLayout::layout");
+    decode(utf8);
+    FontGenerator::getInstance().warmGlyphs(std::u32string_view(text));
+    reflow(maxWidth, lineHeight);
+}
+
+void TextLayout::reflow(const float maxWidth, const float lineHeight) {
+    wrap(LiveMetrics(FontGenerator::getInstance()), maxWidth, lineHeight);
+}
+
+template <typename Metrics>
+void TextLayout::wrap(const Metrics& metrics, const float maxWidth, const float lineHeight) {
+    glyphs.clear();
+    runs.clear();
+    pen = {0.0f, 0.0f};
+    lineCount = text.empty() ? 0 : 1;
+    width = 0.0f;
+
+    startRun(sf::Color::White);
+    std::size_t nextChange = 0;
+    std::size_t lineStart = 0;
+    std::size_t wordStart = 0;
+    std::uint32_t previous = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        while (nextChange < colorChanges.size() && colorChanges[nextChange].position == i) {
+            startRun(colorChanges[nextChange++].color);
+        }
+
+        const std::uint32_t c = text[i];
+        if (c == '\n') {
+            breakLine(glyphs.size(), lineHeight);
+            lineStart = wordStart = glyphs.size();
+            previous = 0;
+            continue;
+        }
+        const float* advance = metrics.advance(c);
+        if (!advance) {
+            continue;
+        }
+
+        if (previous != 0) {
+            pen.x += metrics.kerning(previous, c);
+        }
+        if (c != ' ' && pen.x + *advance > maxWidth && glyphs.size() > lineStart) {
+            const std::size_t first = wordStart > lineStart ? wordStart : glyphs.size();
+            breakLine(first, lineHeight);
+            lineStart = wordStart = first;
+        }
+
+        glyphs.push_back({c, pen});
+        ++runs.back().count;
+        pen.x += *advance;
+        previous = c;
+        if (c == ' ') {
+            wordStart = glyphs.size();
+        }
+    }
+
+    if (runs.back().count == 0) {
+        runs.pop_back();
+    }
+    width = std::max(width, pen.x);
+}
+
+void TextLayoutBatch::clear() {
+    lines.clear();
+    text.clear();
+    glyphs.clear();
+    runs.clear();
+}
+
+void TextLayoutBatch::build(const std::vector<std::pair<std::size_t, std::string_view>>& sources, const float maxWidth,
+                            const float lineHeight) {
+    VN_PROFILE_SCOPE("TextLayoutBatch::build");
+    clear();
+    std::vector<TextLayout> layouts(sources.size());
+    parallelFor(sources.size(), defaultJobCount(), [&](const std::size_t i) { layouts[i].decode(sources[i].second); });
+
+    FontGenerator& fontGenerator = FontGenerator::getInstance();
+    std::unordered_set<std::uint32_t> codepoints;
+    for (const auto& layout : layouts) {
+        codepoints.insert(layout.text.begin(), layout.text.end());
+    }
+
+    MetricsSnapshot metrics;
+    for (const std::uint32_t c : codepoints) {
+        if (const std::optional<float> advance = fontGenerator.getAdvance(c)) {
+            metrics.advances.emplace(c, *advance);
+        }
+    }
+    for (const auto& layout : layouts) {
+        std::uint32_t previous = 0;
+        for (const std::uint32_t c : layout.text) {
+            if (c == '\n') {
+                previous = 0;
+            } else if (metrics.advances.count(c)) {
+                if (previous != 0) {
+                    metrics.kernings.try_emplace(pairKey(previous, c), fontGenerator.getKerning(previous, c));
+                }
+                previous = c;
+            }
+        }
+    }
+
+    parallelFor(layouts.size(), defaultJobCount(), [&](const std::size_t i) { layouts[i].wrap(metrics, maxWidth, lineHeight); });
+
+    std::size_t charCount = 0;
+    std::size_t glyphCount = 0;
+    std::size_t runCount = 0;
+    for (const auto& layout : layouts) {
+        charCount += layout.text.size();
+        glyphCount += layout.glyphs.size();
+        runCount += layout.runs.size();
+    }
+    text.reserve(charCount);
+    glyphs.reserve(glyphCount);
+    runs.reserve(runCount);
+    lines.reserve(layouts.size());
+    for (std::size_t i = 0; i < layouts.size(); ++i) {
+        const TextLayout& layout = layouts[i];
+        lines.push_back({sources[i].first, text.size(), layout.text.size(), glyphs.size(), layout.glyphs.size(),
+                         runs.size(), layout.runs.size()});
+        text += layout.text;
+        glyphs.insert(glyphs.end(), layout.glyphs.begin(), layout.glyphs.end());
+        runs.insert(runs.end(), layout.runs.begin(), layout.runs.end());
+    }
+    std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.key < b.key; });
+}
+
+std::optional<TextLayout::Slice> TextLayoutBatch::find(const std::size_t key) const {
+    const auto line = std::lower_bound(lines.begin(), lines.end(), key,
+                                       [](const Line& candidate, const std::size_t value) { return candidate.key < value; });
+    if (line == lines.end() || line->key != key) {
+        return std::nullopt;
+    }
+    TextLayout::Slice slice;
+    slice.text = std::u32string_view(text).substr(line->firstChar, line->charCount);
+    slice.glyphs = glyphs.data() + line->firstGlyph;
+    slice.glyphCount = line->glyphCount;
+    slice.runs = runs.data() + line->firstRun;
+    slice.runCount = line->runCount;
+    return slice;
+}
+
+std::size_t TextLayoutBatch::getMemoryUsage() const {
+    return lines.capacity() * sizeof(Line) + text.capacity() * sizeof(char32_t) +
+           glyphs.capacity() * sizeof(TextLayout::Glyph) + runs.capacity() * sizeof(TextLayout::Run);
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class TextLayout {
+public:
+    struct Glyph {
+        std::uint32_t codepoint{0};
+        sf::Vector2f position;
+    };
+
+    struct Run {
+        std::size_t first{0};
+        std::size_t count{0};
+        sf::Color color{sf::Color::White};
+    };
+
+    struct Slice {
+        std::u32string_view text;
+        const Glyph* glyphs{nullptr};
+        std::size_t glyphCount{0};
+        const Run* runs{nullptr};
+        std::size_t runCount{0};
+
+        bool isEmpty() const { return glyphCount == 0; }
+    };
+
+    static constexpr float UNLIMITED_WIDTH = std::numeric_limits<float>::infinity();
+
+    void layout(std::string_view utf8, float maxWidth = UNLIMITED_WIDTH, float lineHeight = 0.0f);
+    void decode(std::string_view utf8);
+    void reflow(float maxWidth = UNLIMITED_WIDTH, float lineHeight = 0.0f);
+    void clear();
+
+    std::u32string_view getText() const { return text; }
+    Slice getSlice() const { return {text, glyphs.data(), glyphs.size(), runs.data(), runs.size()}; }
+
+    const std::vector<Glyph>& getGlyphs() const { return glyphs; }
+    const std::vector<Run>& getRuns() const { return runs; }
+    std::size_t getLineCount() const { return lineCount; }
+    float getWidth() const { return width; }
+    bool isEmpty() const { return glyphs.empty(); }
+
+    static std::optional<sf::Color> parseColor(std::string_view value);
+
+private:
+    friend class TextLayoutBatch;
+
+    struct ColorChange {
+        std::size_t position{0};
+        sf::Color color;
+    };
+
+    template <typename Metrics>
+    void wrap(const Metrics& metrics, float maxWidth, float lineHeight);
+    bool parseTag(std::string_view utf8, std::size_t& offset);
+    void startRun(sf::Color color);
+    void breakLine(std::size_t wordStart, float lineHeight);
+
+    std::u32string text;
+    std::vector<ColorChange> colorChanges;
+    std::vector<sf::Color> colorStack;
+    std::vector<Glyph> glyphs;
+    std::vector<Run> runs;
+    sf::Vector2f pen;
+    std::size_t lineCount{0};
+    float width{0.0f};
+};
+
+class TextLayoutBatch {
+public:
+    void build(const std::vector<std::pair<std::size_t, std::string_view>>& lines, float maxWidth, float lineHeight);
+    void clear();
+    std::optional<TextLayout::Slice> find(std::size_t key) const;
+    std::size_t getLineCount() const { return lines.size(); }
+    std::size_t getMemoryUsage() const;
+
+private:
+    struct Line {
+        std::size_t key{0};
+        std::size_t firstChar{0};
+        std::size_t charCount{0};
+        std::size_t firstGlyph{0};
+        std::size_t glyphCount{0};
+        std::size_t firstRun{0};
+        std::size_t runCount{0};
+    };
+
+    std::vector<Line> lines;
+    std::u32string text;
+    std::vector<TextLayout::Glyph> glyphs;
+    std::vector<TextLayout::Run> runs;
+};
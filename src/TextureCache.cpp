@@ -0,0 +1,143 @@
+#include "TextureCache.hpp"
+#include "AssetPack.hpp"
+#include "AtlasPacker.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+TextureCache& TextureCache::getInstance() {
+    static TextureCache instance;
+    return instance;
+}
+
+std::string TextureCache::canonicalKey(const std::string& path) {
+    std::error_code ec;
+    const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, ec);
+    if (ec) {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+    return canonical.generic_string();
+}
+
+TextureCache::Handle TextureCache::acquire(const std::string& path) {
+    const std::string key = canonicalKey(path);
+    std::lock_guard lock(mutex);
+    if (Handle texture = find(key)) {
+        return texture;
+    }
+
+    sf::Texture texture;
+    if (!AssetPack::getInstance().loadTexture(path, texture)) {
+        std::cerr << "Failed to load texture: " << path << std::endl;
+        return nullptr;
+    }
+    return insert(key, std::move(texture));
+}
+
+TextureCache::Handle TextureCache::acquire(const std::string& path, const sf::Image& image) {
+    const std::string key = canonicalKey(path);
+    std::lock_guard lock(mutex);
+    if (Handle texture = find(key)) {
+        return texture;
+    }
+
+    sf::Texture texture;
+    if (!texture.loadFromImage(image)) {
+        std::cerr << "Failed to upload texture: " << path << std::endl;
+        return nullptr;
+    }
+    return insert(key, std::move(texture));
+}
+
+bool TextureCache::contains(const std::string& path) const {
+    const std::string key = canonicalKey(path);
+    std::lock_guard lock(mutex);
+    return find(key) != nullptr;
+}
+
+TextureCache::AtlasHandle TextureCache::findAtlas(const std::string& key) const {
+    std::lock_guard lock(mutex);
+    const auto it = atlases.find(key);
+    return it != atlases.end() ? it->second.lock() : nullptr;
+}
+
+TextureCache::AtlasHandle TextureCache::acquireAtlas(const std::string& key, const sf::Image& image,
+                                                     std::map<std::string, sf::IntRect> frames) {
+    std::lock_guard lock(mutex);
+    if (const auto it = atlases.find(key); it != atlases.end()) {
+        if (AtlasHandle atlas = it->second.lock()) {
+            return atlas;
+        }
+    }
+
+    auto atlas = std::make_shared<Atlas>();
+    if (!atlas->texture.loadFromImage(image)) {
+        std::cerr << "Failed to upload texture atlas: " << key << std::endl;
+        return nullptr;
+    }
+    atlas->frames = std::move(frames);
+    purgeExpired();
+    atlases[key] = atlas;
+    return atlas;
+}
+
+bool TextureCache::packAtlas(const std::map<std::string, sf::Image>& images, sf::Image& atlas,
+                             std::map<std::string, sf::IntRect>& frames) {
+    std::vector<sf::Vector2u> sizes;
+    for (const auto& [path, image] : images) {
+        sizes.push_back(image.getSize() + sf::Vector2u(ATLAS_PADDING, ATLAS_PADDING));
+    }
+    sf::Vector2u atlasSize;
+    std::vector<sf::Vector2u> positions;
+    if (images.empty() || !AtlasPacker::packAll(sizes, std::min(MAX_ATLAS_SIZE, sf::Texture::getMaximumSize()), atlasSize, positions)) {
+        return false;
+    }
+
+    atlas.resize(atlasSize, sf::Color::Transparent);
+    frames.clear();
+    std::size_t index = 0;
+    for (const auto& [path, image] : images) {
+        const sf::Vector2u position = positions[index++];
+        if (!atlas.copy(image, position)) {
+            return false;
+        }
+        frames.emplace(path, sf::IntRect(sf::Vector2i(position), sf::Vector2i(image.getSize())));
+    }
+    return true;
+}
+
+std::size_t TextureCache::countTexture(const sf::Texture* texture, CountedTextures& counted) {
+    if (!texture || !counted.insert(texture).second) {
+        return 0;
+    }
+    return static_cast<std::size_t>(texture->getSize().x) * texture->getSize().y * 4;
+}
+
+TextureCache::Handle TextureCache::find(const std::string& key) const {
+    const auto it = textures.find(key);
+    return it != textures.end() ? it->second.lock() : nullptr;
+}
+
+TextureCache::Handle TextureCache::insert(const std::string& key, sf::Texture&& texture) {
+    purgeExpired();
+    Handle handle = std::make_shared<const sf::Texture>(std::move(texture));
+    textures[key] = handle;
+    return handle;
+}
+
+void TextureCache::purgeExpired() {
+    for (auto it = textures.begin(); it != textures.end();) {
+        if (it->second.expired()) {
+            it = textures.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = atlases.begin(); it != atlases.end();) {
+        if (it->second.expired()) {
+            it = atlases.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+class TextureCache {
+public:
+    using Handle = std::shared_ptr<const sf::Texture>;
+
+    struct Atlas {
+        sf::Texture texture;
+        std::map<std::string, sf::IntRect> frames;
+    };
+    using AtlasHandle = std::shared_ptr<const Atlas>;
+
+    using CountedTextures = std::unordered_set<const sf::Texture*>;
+    static std::size_t countTexture(const sf::Texture* texture, CountedTextures& counted);
+
+    static constexpr unsigned int ATLAS_PADDING = 2;
+    static constexpr unsigned int MAX_ATLAS_SIZE = 4096;
+
+    static TextureCache& getInstance();
+
+    Handle acquire(const std::string& path);
+    Handle acquire(const std::string& path, const sf::Image& image);
+    bool contains(const std::string& path) const;
+    AtlasHandle findAtlas(const std::string& key) const;
+    AtlasHandle acquireAtlas(const std::string& key, const sf::Image& image, std::map<std::string, sf::IntRect> frames);
+    static Handle atlasTexture(const AtlasHandle& atlas) { return Handle(atlas, &atlas->texture); }
+    static bool packAtlas(const std::map<std::string, sf::Image>& images, sf::Image& atlas,
+                          std::map<std::string, sf::IntRect>& frames);
+
+    static std::string canonicalKey(const std::string& path);
+
+private:
+    TextureCache() = default;
+
+    Handle find(const std::string& key) const;
+    Handle insert(const std::string& key, sf::Texture&& texture);
+    void purgeExpired();
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<const sf::Texture>> textures;
+    std::unordered_map<std::string, std::weak_ptr<const Atlas>> atlases;
+};
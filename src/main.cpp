@@ -1,9 +1,17 @@
 #include <SFML/Graphics.hpp>
+#include <cstring>
 #include "Game.hpp"
 
-int main()
+int main(int argc, char* argv[])
 {
-    Game game;
+    bool threaded = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threaded") == 0) {
+            threaded = true;
+        }
+    }
+
+    Game game(threaded);
     game.run();
     return 0;
 }
@@ -0,0 +1,292 @@
+#include "CompiledScript.hpp"
+#include "Parallel.hpp"
+#include "ScriptParser.hpp"
+#include "ScriptReader.hpp"
+#include <SFML/Audio/InputSoundFile.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class AssetKind {
+    IMAGE,
+    MUSIC,
+    SOUND,
+    FONT
+};
+
+struct AssetReference {
+    std::string path;
+    AssetKind kind;
+    std::string label;
+};
+
+struct AssetReport {
+    AssetKind kind{AssetKind::IMAGE};
+    bool exists{false};
+    std::uint64_t fileBytes{0};
+    std::uint64_t textureBytes{0};
+    double decodeMs{0.0};
+    std::string error;
+};
+
+struct SceneReport {
+    std::string scriptPath;
+    std::string name;
+    bool parsed{false};
+    std::size_t commandCount{0};
+    std::string nextScene;
+    std::vector<AssetReference> assets;
+    std::vector<std::string> errors;
+    std::vector<std::string> warnings;
+};
+
+std::string assetKey(const std::string& path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::string formatBytes(const std::uint64_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (bytes >= 1024 * 1024) {
+        out << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MB";
+    } else {
+        out << static_cast<double>(bytes) / 1024.0 << " KB";
+    }
+    return out.str();
+}
+
+ScriptData loadFullScript(const std::string& scriptPath, std::vector<std::string>& errors) {
+    ScriptData data = ScriptParser::loadScript(scriptPath);
+    if (const auto reader = data.reader) {
+        while (!reader->isFinished()) {
+            std::vector<ScriptCommand> commands = reader->readChunk(ScriptReader::CHUNK_SIZE);
+            ScriptParser::resolveReferences(data, commands, data.commands.getEndIndex(), errors);
+            for (const auto& cmd : commands) {
+                data.commands.append(cmd);
+            }
+        }
+    }
+    return data;
+}
+
+void checkScene(SceneReport& scene) {
+    try {
+        ScriptData data = loadFullScript(scene.scriptPath, scene.errors);
+        scene.errors.insert(scene.errors.begin(), data.errors.begin(), data.errors.end());
+        scene.parsed = true;
+        scene.commandCount = data.commands.getEndIndex();
+        scene.nextScene = data.nextScenePath;
+
+        scene.assets.push_back({data.backgroundPath, AssetKind::IMAGE, "background"});
+        scene.assets.push_back({data.fontPath, AssetKind::FONT, "font"});
+        for (const auto& [charName, charData] : data.characterData) {
+            for (const auto& [expression, path] : charData.sprites) {
+                scene.assets.push_back({path, AssetKind::IMAGE, "sprite " + charName + "/" + expression});
+            }
+            if (!charData.sprites.count("default")) {
+                scene.warnings.push_back("character '" + charName + "' has no default expression");
+            }
+        }
+        for (const auto& [trackName, track] : data.musicTracks) {
+            scene.assets.push_back({track.path, AssetKind::MUSIC, "music track " + trackName});
+        }
+        for (const auto& [soundName, sound] : data.sounds) {
+            scene.assets.push_back({sound.path, AssetKind::SOUND, "sound " + soundName});
+        }
+    } catch (const std::exception& e) {
+        scene.errors.push_back(std::string("failed to parse: ") + e.what());
+    }
+}
+
+void checkAsset(const std::string& path, AssetReport& asset, const bool decode) {
+    std::error_code ec;
+    asset.exists = std::filesystem::is_regular_file(path, ec);
+    if (!asset.exists) {
+        asset.error = "not found";
+        return;
+    }
+    asset.fileBytes = std::filesystem::file_size(path, ec);
+    if (!decode) {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    switch (asset.kind) {
+        case AssetKind::IMAGE: {
+            sf::Image image;
+            if (image.loadFromFile(path)) {
+                asset.textureBytes = static_cast<std::uint64_t>(image.getSize().x) * image.getSize().y * 4;
+            } else {
+                asset.error = "cannot be decoded as an image";
+            }
+            break;
+        }
+        case AssetKind::MUSIC: {
+            sf::InputSoundFile sound;
+            if (!sound.openFromFile(path)) {
+                asset.error = "cannot be opened as audio";
+            }
+            break;
+        }
+        case AssetKind::SOUND: {
+            sf::SoundBuffer buffer;
+            if (!buffer.loadFromFile(path)) {
+                asset.error = "cannot be decoded as audio";
+            }
+            break;
+        }
+        case AssetKind::FONT: {
+            sf::Font font;
+            if (!font.openFromFile(path)) {
+                asset.error = "cannot be opened as a font";
+            }
+            break;
+        }
+    }
+    asset.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string scriptsDirectory = "assets/scripts";
+    bool decode = true;
+    unsigned int jobs = defaultJobCount();
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--stat-only") {
+            decode = false;
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--help") {
+            std::cout << "Usage: vn_check [--stat-only] [--jobs N] [scripts_dir]\n"
+                      << "Run from the project root so asset paths resolve as they do in game.\n";
+            return 0;
+        } else {
+            scriptsDirectory = arg;
+        }
+    }
+
+    std::error_code ec;
+    if (!std::filesystem::is_directory(scriptsDirectory, ec)) {
+        std::cerr << "Scripts directory not found: " << scriptsDirectory << std::endl;
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::string> scripts = ScriptParser::findScripts(scriptsDirectory);
+
+    std::vector<SceneReport> scenes(scripts.size());
+    std::map<std::string, std::size_t> sceneIndex;
+    for (std::size_t i = 0; i < scripts.size(); ++i) {
+        scenes[i].scriptPath = scripts[i];
+        scenes[i].name = std::filesystem::path(scripts[i]).filename().string();
+        sceneIndex[scenes[i].name] = i;
+    }
+    parallelFor(scenes.size(), jobs, [&](const std::size_t i) { checkScene(scenes[i]); });
+
+    std::map<std::string, AssetReport> assets;
+    for (const auto& scene : scenes) {
+        for (const auto& reference : scene.assets) {
+            assets[assetKey(reference.path)].kind = reference.kind;
+        }
+    }
+    std::vector<std::pair<const std::string, AssetReport>*> assetList;
+    for (auto& entry : assets) {
+        assetList.push_back(&entry);
+    }
+    parallelFor(assetList.size(), jobs, [&](const std::size_t i) {
+        checkAsset(assetList[i]->first, assetList[i]->second, decode);
+    });
+
+    std::set<std::string> reachable;
+    if (!scenes.empty()) {
+        for (std::size_t current = 0; reachable.insert(scenes[current].name).second;) {
+            const std::string& next = scenes[current].nextScene;
+            const auto it = sceneIndex.find(next);
+            if (next == "exit" || it == sceneIndex.end() || !scenes[it->second].parsed) {
+                break;
+            }
+            current = it->second;
+        }
+    }
+
+    for (auto& scene : scenes) {
+        if (scene.parsed && scene.nextScene != "exit" && !sceneIndex.count(scene.nextScene)) {
+            const std::string nextPath = scriptsDirectory + "/" + scene.nextScene;
+            if (!std::filesystem::exists(nextPath, ec) &&
+                !std::filesystem::exists(CompiledScript::compiledPathFor(nextPath), ec)) {
+                scene.errors.push_back("next_scene '" + scene.nextScene + "' does not exist");
+            }
+        }
+        if (scene.parsed && !reachable.count(scene.name)) {
+            scene.warnings.push_back("not reachable from the first scene through next_scene");
+        }
+        for (const auto& reference : scene.assets) {
+            const AssetReport& asset = assets[assetKey(reference.path)];
+            if (!asset.error.empty()) {
+                scene.errors.push_back(reference.label + " '" + reference.path + "' " + asset.error);
+            }
+        }
+    }
+
+    std::size_t errorCount = 0;
+    std::size_t warningCount = 0;
+    for (const auto& scene : scenes) {
+        for (const auto& error : scene.errors) {
+            std::cout << scene.scriptPath << ": error: " << error << "\n";
+        }
+        for (const auto& warning : scene.warnings) {
+            std::cout << scene.scriptPath << ": warning: " << warning << "\n";
+        }
+        errorCount += scene.errors.size();
+        warningCount += scene.warnings.size();
+    }
+
+    std::cout << "\n" << std::left << std::setw(32) << "scene" << std::right
+              << std::setw(8) << "cmds" << std::setw(8) << "assets"
+              << std::setw(12) << "on disk" << std::setw(12) << "textures"
+              << std::setw(12) << "decode" << "\n";
+    for (const auto& scene : scenes) {
+        std::set<std::string> unique;
+        std::uint64_t fileBytes = 0;
+        std::uint64_t textureBytes = 0;
+        double decodeMs = 0.0;
+        for (const auto& reference : scene.assets) {
+            const std::string key = assetKey(reference.path);
+            if (!unique.insert(key).second) {
+                continue;
+            }
+            const AssetReport& asset = assets[key];
+            fileBytes += asset.fileBytes;
+            textureBytes += asset.textureBytes;
+            decodeMs += asset.decodeMs;
+        }
+        std::ostringstream decodeTime;
+        decodeTime << std::fixed << std::setprecision(1) << decodeMs << " ms";
+        std::cout << std::left << std::setw(32) << scene.name << std::right
+                  << std::setw(8) << scene.commandCount << std::setw(8) << unique.size()
+                  << std::setw(12) << formatBytes(fileBytes)
+                  << std::setw(12) << (decode ? formatBytes(textureBytes) : "-")
+                  << std::setw(12) << (decode ? decodeTime.str() : "-") << "\n";
+    }
+
+    const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\n" << scenes.size() << " scripts, " << assets.size() << " assets checked in "
+              << std::fixed << std::setprecision(0) << elapsed << " ms on " << jobs << " threads: "
+              << errorCount << " errors, " << warningCount << " warnings\n";
+    return errorCount == 0 ? 0 : 1;
+}
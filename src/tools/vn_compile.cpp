@@ -0,0 +1,91 @@
+#include "CompiledScript.hpp"
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+void reportMemory(const std::string& scriptPath, const ScriptData& data) {
+    std::vector<ScriptCommand> commands;
+    commands.reserve(data.commands.size());
+    for (std::size_t i = 0; i < data.commands.size(); ++i) {
+        commands.push_back(data.commands.toCommand(i));
+    }
+
+    const std::size_t vectorBytes = CommandStream::estimateMemoryUsage(commands);
+    const std::size_t streamBytes = data.commands.getMemoryUsage();
+    std::cout << scriptPath << ": " << data.commands.size() << " commands, "
+              << vectorBytes << " bytes as ScriptCommand vector, "
+              << streamBytes << " bytes as command stream ("
+              << (vectorBytes ? streamBytes * 100 / vectorBytes : 0) << "%)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string scriptsDirectory = "assets/scripts";
+    bool force = false;
+    bool memory = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--force") {
+            force = true;
+        } else if (arg == "--memory") {
+            memory = true;
+        } else if (arg == "--help") {
+            std::cout << "Usage: vn_compile [--force] [--memory] [scripts_dir]\n";
+            return 0;
+        } else {
+            scriptsDirectory = arg;
+        }
+    }
+
+    std::error_code ec;
+    if (!std::filesystem::is_directory(scriptsDirectory, ec)) {
+        std::cerr << "Scripts directory not found: " << scriptsDirectory << std::endl;
+        return 1;
+    }
+
+    int compiled = 0;
+    int skipped = 0;
+    int failed = 0;
+
+    for (const auto& entry : std::filesystem::directory_iterator(scriptsDirectory)) {
+        if (entry.path().extension() != ".yaml") {
+            continue;
+        }
+
+        const std::string scriptPath = entry.path().string();
+        std::optional<ScriptData> data;
+        if (memory) {
+            try {
+                data = ScriptParser::parseScript(scriptPath);
+            } catch (const YAML::Exception& e) {
+                std::cerr << "Failed to parse script " << scriptPath << ": " << e.what() << std::endl;
+                ++failed;
+                continue;
+            }
+            reportMemory(scriptPath, *data);
+        }
+        const std::string outputPath = CompiledScript::compiledPathFor(scriptPath);
+        if (!force && CompiledScript::isUpToDate(outputPath, scriptPath)) {
+            ++skipped;
+            continue;
+        }
+
+        const bool written = data ? CompiledScript::compile(scriptPath, *data, outputPath)
+                                  : CompiledScript::compile(scriptPath, outputPath);
+        if (written) {
+            std::cout << "Compiled " << scriptPath << " -> " << outputPath << "\n";
+            ++compiled;
+        } else {
+            ++failed;
+        }
+    }
+
+    std::cout << compiled << " compiled, " << skipped << " up to date, " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}
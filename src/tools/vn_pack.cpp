@@ -0,0 +1,272 @@
+#include "AssetPack.hpp"
+#include "ImageResampler.hpp"
+#include "Parallel.hpp"
+#include "ScriptParser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string outputPath{AssetPack::DEFAULT_PATH};
+    std::string scriptsDirectory{"assets/scripts"};
+    std::vector<std::string> roots;
+    sf::Vector2u target{1280u, 720u};
+    float tier{1.0f};
+    bool resize{true};
+    unsigned int jobs{defaultJobCount()};
+};
+
+struct ImageRole {
+    bool background{false};
+    bool sprite{false};
+};
+
+struct PackedImage {
+    std::string key;
+    std::filesystem::path path;
+    ImageRole role;
+    std::vector<std::uint8_t> data;
+    sf::Vector2u sourceSize;
+    sf::Vector2u packedSize;
+    sf::Vector2f scale{1.0f, 1.0f};
+};
+
+void printUsage() {
+    std::cout << "Usage: vn_pack [options] [directory...]\n"
+              << "  -o <file>              output pack (default assets.vnpack)\n"
+              << "  --scripts <dir>        scripts used to find backgrounds and sprites (default assets/scripts)\n"
+              << "  --target <W>x<H>       logical resolution backgrounds must cover (default 1280x720)\n"
+              << "  --tier <scale>         quality tier in (0, 1]; also shrinks sprites (default 1)\n"
+              << "  --no-resize            pack images unchanged\n"
+              << "  --jobs <n>             worker threads for resampling\n"
+              << "Run from the project root; entries are stored by their path relative to it.\n";
+}
+
+sf::Vector2u parseSize(const std::string& value) {
+    const std::size_t separator = value.find('x');
+    if (separator == std::string::npos) {
+        throw std::invalid_argument("size");
+    }
+    const auto parseSide = [](const std::string& side) {
+        std::size_t parsed = 0;
+        const unsigned long number = std::stoul(side, &parsed);
+        if (side.empty() || !std::isdigit(static_cast<unsigned char>(side[0])) || parsed != side.size() || number == 0 ||
+            number > std::numeric_limits<unsigned int>::max()) {
+            throw std::invalid_argument("size");
+        }
+        return static_cast<unsigned int>(number);
+    };
+    return {parseSide(value.substr(0, separator)), parseSide(value.substr(separator + 1))};
+}
+
+bool parseOptions(const int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        try {
+            if ((arg == "-o" || arg == "--output") && hasValue) {
+                options.outputPath = argv[++i];
+            } else if (arg == "--scripts" && hasValue) {
+                options.scriptsDirectory = argv[++i];
+            } else if (arg == "--target" && hasValue) {
+                options.target = parseSize(argv[++i]);
+            } else if (arg == "--tier" && hasValue) {
+                options.tier = std::stof(argv[++i]);
+                if (!(options.tier > 0.0f && options.tier <= 1.0f)) {
+                    throw std::invalid_argument("tier");
+                }
+            } else if (arg == "--jobs" && hasValue) {
+                options.jobs = static_cast<unsigned int>(std::max(1, std::stoi(argv[++i])));
+            } else if (arg == "--no-resize") {
+                options.resize = false;
+            } else if (arg == "--help") {
+                printUsage();
+                return false;
+            } else if (!arg.empty() && arg[0] != '-') {
+                options.roots.push_back(arg);
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                printUsage();
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.roots.empty()) {
+        options.roots.emplace_back("assets");
+    }
+    return true;
+}
+
+std::string packKey(std::filesystem::path path, const std::filesystem::path& projectRoot) {
+    if (path.is_absolute()) {
+        path = path.lexically_relative(projectRoot);
+    }
+    return path.lexically_normal().generic_string();
+}
+
+bool isExcluded(const std::filesystem::path& path, const std::filesystem::path& root, const std::filesystem::path& output) {
+    std::error_code ec;
+    if (std::filesystem::equivalent(path, output, ec)) {
+        return true;
+    }
+    const std::filesystem::path relative = path.lexically_relative(root);
+    return !relative.empty() && *relative.begin() == "cache";
+}
+
+std::string imageFormat(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".png" || extension == ".bmp" || extension == ".tga") {
+        return extension.substr(1);
+    }
+    if (extension == ".jpg" || extension == ".jpeg") {
+        return "jpg";
+    }
+    return {};
+}
+
+std::map<std::string, ImageRole> collectImageRoles(const std::string& scriptsDirectory, const std::filesystem::path& projectRoot) {
+    std::map<std::string, ImageRole> roles;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(scriptsDirectory, ec)) {
+        return roles;
+    }
+
+    for (const auto& script : ScriptParser::findScripts(scriptsDirectory)) {
+        try {
+            const ScriptData data = ScriptParser::loadScript(script);
+            if (!data.backgroundPath.empty()) {
+                roles[packKey(data.backgroundPath, projectRoot)].background = true;
+            }
+            for (const auto& [charName, charData] : data.characterData) {
+                for (const auto& [expression, path] : charData.sprites) {
+                    roles[packKey(path, projectRoot)].sprite = true;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to read script " << script << ": " << e.what() << std::endl;
+        }
+    }
+    return roles;
+}
+
+void optimizeImage(PackedImage& image, const Options& options) {
+    sf::Image source;
+    if (!source.loadFromFile(image.path)) {
+        std::cerr << "Failed to decode image, packing it unchanged: " << image.path.string() << std::endl;
+        return;
+    }
+    image.sourceSize = image.packedSize = source.getSize();
+
+    sf::Vector2u targetSize = source.getSize();
+    if (image.role.sprite) {
+        targetSize = ImageResampler::scaledSize(source.getSize(), options.tier);
+    } else if (image.role.background) {
+        const sf::Vector2u cover{std::max(1u, static_cast<unsigned int>(options.target.x * options.tier)),
+                                 std::max(1u, static_cast<unsigned int>(options.target.y * options.tier))};
+        targetSize = ImageResampler::coverSize(source.getSize(), cover);
+    }
+    if (targetSize == source.getSize()) {
+        return;
+    }
+
+    const sf::Image resized = ImageResampler::resize(source, targetSize);
+    const auto encoded = resized.saveToMemory(imageFormat(image.path));
+    if (!encoded) {
+        std::cerr << "Failed to encode image, packing it unchanged: " << image.path.string() << std::endl;
+        return;
+    }
+    image.data = *encoded;
+    image.packedSize = targetSize;
+    image.scale = {static_cast<float>(targetSize.x) / static_cast<float>(source.getSize().x),
+                   static_cast<float>(targetSize.y) / static_cast<float>(source.getSize().y)};
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::error_code ec;
+    const std::filesystem::path projectRoot = std::filesystem::current_path(ec);
+    std::vector<std::pair<std::string, std::filesystem::path>> files;
+    for (const auto& root : options.roots) {
+        if (!std::filesystem::is_directory(root, ec)) {
+            std::cerr << "Asset directory not found: " << root << std::endl;
+            return 1;
+        }
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+            if (entry.is_regular_file() && !isExcluded(entry.path(), root, options.outputPath)) {
+                files.emplace_back(packKey(entry.path(), projectRoot), entry.path());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<PackedImage> images;
+    std::map<std::string, std::size_t> imageIndex;
+    if (options.resize) {
+        const std::map<std::string, ImageRole> roles = collectImageRoles(options.scriptsDirectory, projectRoot);
+        for (const auto& [key, path] : files) {
+            const auto role = roles.find(key);
+            if (role != roles.end() && !imageFormat(path).empty()) {
+                imageIndex[key] = images.size();
+                PackedImage& image = images.emplace_back();
+                image.key = key;
+                image.path = path;
+                image.role = role->second;
+            }
+        }
+        parallelFor(images.size(), options.jobs, [&](const std::size_t i) { optimizeImage(images[i], options); });
+    }
+
+    AssetPackWriter writer;
+    if (!writer.open(options.outputPath)) {
+        return 1;
+    }
+    std::size_t resizedCount = 0;
+    std::uint64_t sourcePixels = 0;
+    std::uint64_t packedPixels = 0;
+    for (const auto& [key, path] : files) {
+        const auto image = imageIndex.find(key);
+        if (image != imageIndex.end() && !images[image->second].data.empty()) {
+            const PackedImage& packed = images[image->second];
+            if (!writer.add(key, reinterpret_cast<const char*>(packed.data.data()), packed.data.size(), packed.scale)) {
+                return 1;
+            }
+            ++resizedCount;
+        } else if (!writer.addFile(key, path.string())) {
+            return 1;
+        }
+        if (image != imageIndex.end()) {
+            const PackedImage& packed = images[image->second];
+            sourcePixels += static_cast<std::uint64_t>(packed.sourceSize.x) * packed.sourceSize.y;
+            packedPixels += static_cast<std::uint64_t>(packed.packedSize.x) * packed.packedSize.y;
+        }
+    }
+    if (!writer.finish()) {
+        return 1;
+    }
+
+    std::cout << "Packed " << writer.getEntryCount() << " assets into " << options.outputPath
+              << " (" << writer.getSize() / 1024 << " KB)" << std::endl;
+    if (!images.empty()) {
+        std::cout << "Resampled " << resizedCount << " of " << images.size() << " scene images: texture memory "
+                  << sourcePixels * 4 / (1024 * 1024) << " MB -> " << packedPixels * 4 / (1024 * 1024) << " MB" << std::endl;
+    }
+    return 0;
+}
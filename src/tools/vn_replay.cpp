@@ -0,0 +1,232 @@
+#include "SceneManager.hpp"
+#include "AssetPack.hpp"
+#include "Profiler.hpp"
+#include <SFML/Audio/Listener.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct FrameTiming {
+    double update{0.0};
+    double render{0.0};
+};
+
+struct Options {
+    std::string scriptsDirectory{"assets/scripts"};
+    std::string csvPath;
+    std::string tracePath;
+    std::string packPath{AssetPack::DEFAULT_PATH};
+    float deltaTime{1.0f / 60.0f};
+    unsigned int advanceEvery{30};
+    std::size_t maxFrames{100000};
+    bool skip{false};
+    bool render{true};
+    bool audio{false};
+};
+
+void printUsage() {
+    std::cout << "Usage: vn_replay [options] [scripts_dir]\n"
+              << "  --dt <seconds>         fixed timestep (default 1/60)\n"
+              << "  --advance-every <n>    press advance once every n frames (default 30)\n"
+              << "  --skip                 hold skip for the whole run\n"
+              << "  --max-frames <n>       stop after n frames (default 100000)\n"
+              << "  --no-render            only run the simulation\n"
+              << "  --audio                keep music audible\n"
+              << "  --pack <file>          asset pack to mount (default assets.vnpack)\n"
+              << "  --csv <file>           write per-frame timings\n"
+              << "  --trace <file>         write profiler scopes as Chrome trace JSON\n";
+}
+
+bool parseOptions(const int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--dt" && hasValue) {
+                options.deltaTime = std::stof(argv[++i]);
+            } else if (arg == "--advance-every" && hasValue) {
+                options.advanceEvery = static_cast<unsigned int>(std::stoul(argv[++i]));
+            } else if (arg == "--max-frames" && hasValue) {
+                options.maxFrames = std::stoull(argv[++i]);
+            } else if (arg == "--csv" && hasValue) {
+                options.csvPath = argv[++i];
+            } else if (arg == "--pack" && hasValue) {
+                options.packPath = argv[++i];
+            } else if (arg == "--trace" && hasValue) {
+                options.tracePath = argv[++i];
+            } else if (arg == "--skip") {
+                options.skip = true;
+            } else if (arg == "--no-render") {
+                options.render = false;
+            } else if (arg == "--audio") {
+                options.audio = true;
+            } else if (arg == "--help") {
+                printUsage();
+                return false;
+            } else if (!arg.empty() && arg[0] != '-') {
+                options.scriptsDirectory = arg;
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                printUsage();
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options.deltaTime <= 0.0f) {
+        std::cerr << "--dt must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+InputState scriptedInput(const Options& options, const std::size_t frame) {
+    InputState input;
+    input.skip = options.skip;
+    input.advance = options.advanceEvery > 0 && frame % options.advanceEvery == options.advanceEvery - 1;
+    return input;
+}
+
+double percentile(const std::vector<double>& sorted, const double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void printStats(const std::string& label, std::vector<double> samples) {
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (const double sample : samples) {
+        total += sample;
+    }
+
+    std::cout << std::left << std::setw(8) << label << std::right << std::fixed << std::setprecision(3)
+              << " mean " << std::setw(8) << total / static_cast<double>(samples.size())
+              << "  p50 " << std::setw(8) << percentile(samples, 0.50)
+              << "  p95 " << std::setw(8) << percentile(samples, 0.95)
+              << "  p99 " << std::setw(8) << percentile(samples, 0.99)
+              << "  max " << std::setw(8) << samples.back() << "  (ms)\n";
+}
+
+double millisecondsSince(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    if (!options.audio) {
+        sf::Listener::setGlobalVolume(0.0f);
+    }
+
+    std::optional<sf::RenderTexture> target;
+    if (options.render) {
+        target.emplace();
+        if (!target->resize({1280u, 720u})) {
+            std::cerr << "Failed to create offscreen render target" << std::endl;
+            return 1;
+        }
+    }
+
+    const auto loadStart = std::chrono::steady_clock::now();
+    AssetPack::getInstance().mount(options.packPath);
+    SceneManager sceneManager(options.scriptsDirectory);
+    if (!sceneManager.initialize()) {
+        std::cerr << "Failed to load scripts from " << options.scriptsDirectory << std::endl;
+        return 1;
+    }
+    const double loadTime = millisecondsSince(loadStart);
+
+    std::vector<FrameTiming> frames;
+    frames.reserve(std::min<std::size_t>(options.maxFrames, 1 << 16));
+    std::size_t sceneSwitches = 0;
+    bool finished = false;
+
+    const auto runStart = std::chrono::steady_clock::now();
+    for (std::size_t frame = 0; frame < options.maxFrames && !finished; ++frame) {
+        FrameTiming timing;
+
+        const auto updateStart = std::chrono::steady_clock::now();
+        const Scene* sceneBefore = sceneManager.getCurrentScene();
+        sceneManager.setInput(scriptedInput(options, frame));
+        sceneManager.update(options.deltaTime);
+        finished = !sceneManager.advanceFinishedScene() || sceneManager.shouldExit();
+        if (sceneManager.getCurrentScene() != sceneBefore) {
+            ++sceneSwitches;
+        }
+        timing.update = millisecondsSince(updateStart);
+
+        if (target) {
+            const auto renderStart = std::chrono::steady_clock::now();
+            target->clear();
+            sceneManager.render(*target);
+            target->display();
+            timing.render = millisecondsSince(renderStart);
+        }
+
+        frames.push_back(timing);
+    }
+    const double runTime = millisecondsSince(runStart);
+
+    std::vector<double> updateTimes;
+    std::vector<double> renderTimes;
+    std::vector<double> frameTimes;
+    updateTimes.reserve(frames.size());
+    renderTimes.reserve(frames.size());
+    frameTimes.reserve(frames.size());
+    for (const auto& timing : frames) {
+        updateTimes.push_back(timing.update);
+        renderTimes.push_back(timing.render);
+        frameTimes.push_back(timing.update + timing.render);
+    }
+
+    std::cout << frames.size() << " frames, " << sceneSwitches << " scene switches, "
+              << std::fixed << std::setprecision(2)
+              << static_cast<double>(frames.size()) * options.deltaTime << " s simulated, "
+              << runTime << " ms wall, " << loadTime << " ms initial load"
+              << (finished ? "" : " (frame limit reached)") << "\n";
+    printStats("update", updateTimes);
+    if (target) {
+        printStats("render", renderTimes);
+    }
+    printStats("frame", frameTimes);
+
+    if (!options.csvPath.empty()) {
+        std::ofstream csv(options.csvPath);
+        if (!csv) {
+            std::cerr << "Failed to write " << options.csvPath << std::endl;
+            return 1;
+        }
+        csv << "frame,update_ms,render_ms\n";
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            csv << i << ',' << frames[i].update << ',' << frames[i].render << '\n';
+        }
+    }
+
+    if (!options.tracePath.empty() && !Profiler::getInstance().writeChromeTrace(options.tracePath)) {
+        return 1;
+    }
+
+    return 0;
+}